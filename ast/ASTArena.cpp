@@ -0,0 +1,3 @@
+#include "ast/ASTArena.h"
+
+thread_local ASTArena TheASTArena;
@@ -0,0 +1,46 @@
+#ifndef __AST_ARENA_H__
+#define __AST_ARENA_H__
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// ASTArena - Bump allocator that holds every ExprAST node of the top-level
+// item being parsed, together with the child lists they refer to. Nodes
+// are never destroyed one by one: once the item has been generated the
+// whole arena is reset in one go. Everything placed in it must therefore be
+// trivially destructible apart from the nodes themselves, which must not
+// own any heap memory.
+class ASTArena {
+  llvm::BumpPtrAllocator Allocator;
+
+public:
+  template <typename T, typename... ArgTs> T *create(ArgTs &&... Args) {
+    return new (Allocator.Allocate<T>()) T(std::forward<ArgTs>(Args)...);
+  }
+
+  // The copy is mutable, so that passes over the tree can replace children
+  template <typename T>
+  llvm::MutableArrayRef<T> copyArray(llvm::ArrayRef<T> A) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "arena arrays are never destroyed");
+    if (A.empty())
+      return llvm::MutableArrayRef<T>();
+    T *Mem = Allocator.Allocate<T>(A.size());
+    std::uninitialized_copy(A.begin(), A.end(), Mem);
+    return llvm::MutableArrayRef<T>(Mem, A.size());
+  }
+
+  // Frees everything at once, the first slab is kept for the next item
+  void reset() { Allocator.Reset(); }
+
+  size_t getBytesAllocated() const { return Allocator.getBytesAllocated(); }
+};
+
+// The arena the parser allocates from, every parsing thread has its own
+extern thread_local ASTArena TheASTArena;
+
+#endif
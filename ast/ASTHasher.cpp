@@ -0,0 +1,64 @@
+#include "ast/ASTHasher.h"
+#include "ast/ExprAST.h"
+#include "ast/PrototypeAST.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Endian.h"
+
+#include <cstring>
+
+void ASTHasher::add(unsigned N) {
+  uint8_t Bytes[4];
+  llvm::support::endian::write32le(Bytes, N);
+  Hash.update(Bytes);
+}
+
+void ASTHasher::add(double Val) {
+  // The bit pattern, so that e.g. 0.0 and -0.0 stay apart
+  uint64_t Bits;
+  memcpy(&Bits, &Val, sizeof(Bits));
+  uint8_t Bytes[8];
+  llvm::support::endian::write64le(Bytes, Bits);
+  Hash.update(Bytes);
+}
+
+void ASTHasher::add(llvm::StringRef Text) {
+  add((unsigned)Text.size());
+  Hash.update(Text);
+}
+
+void ASTHasher::add(Symbol Name) {
+  // Symbol ids depend on the order names are first seen, so hash the text
+  add(Name.getName());
+}
+
+void ASTHasher::add(const ExprAST *Child) {
+  if (!Child) {
+    add('0');
+    return;
+  }
+  Child->hash(*this);
+}
+
+void ASTHasher::add(const PrototypeAST &Proto) {
+  add('P');
+  add(Proto.getName());
+  add((unsigned)Proto.getArgs().size());
+  for (unsigned I = 0, E = Proto.getArgs().size(); I != E; ++I) {
+    add(Proto.getArgs()[I]);
+    add((unsigned)Proto.getArgType(I));
+    add((unsigned)Proto.getArgAttributes(I).NoAlias);
+    add(Proto.getArgAttributes(I).Align);
+  }
+  add((unsigned)Proto.getReturnType());
+  add((unsigned)(Proto.isUnaryOp() || Proto.isBinaryOp()));
+  add(Proto.getBinaryPrecedence());
+  add((unsigned)Proto.isSequencing());
+  add((unsigned)Proto.isPure());
+  add((unsigned)Proto.getMemoryEffects());
+  add((unsigned)Proto.willReturn());
+}
+
+std::string ASTHasher::finish() {
+  return llvm::toHex(Hash.final(), /*LowerCase=*/true);
+}
@@ -0,0 +1,45 @@
+#ifndef __AST_HASHER_H__
+#define __AST_HASHER_H__
+
+#include "lexer/symbol.h"
+
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/SHA1.h"
+
+#include <string>
+
+class ExprAST;
+class PrototypeAST;
+
+// ASTHasher - Digests the structure of a function for the function cache.
+// Every node adds a tag for its kind followed by its fields and children,
+// so two trees hash alike only when they would generate the same code. The
+// functions a body calls are collected on the way, since the code of a call
+// depends on the callee's prototype as well
+class ASTHasher {
+  llvm::SHA1 Hash;
+  llvm::SetVector<Symbol> Callees;
+
+public:
+  void add(char Tag) { Hash.update(llvm::StringRef(&Tag, 1)); }
+  void add(unsigned N);
+  void add(double Val);
+  void add(llvm::StringRef Text);
+  void add(Symbol Name);
+
+  // A child node, Child may be null
+  void add(const ExprAST *Child);
+
+  void add(const PrototypeAST &Proto);
+
+  // Records that the body calls Callee, the caller hashes its prototype
+  void addCallee(Symbol Callee) { Callees.insert(Callee); }
+
+  // The functions passed to addCallee so far, in the order they came
+  llvm::ArrayRef<Symbol> getCallees() const { return Callees.getArrayRef(); }
+
+  // The digest as 40 hex digits, the hasher must not be used afterwards
+  std::string finish();
+};
+
+#endif
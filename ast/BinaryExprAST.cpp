@@ -1,58 +1,247 @@
 #include "ast/BinaryExprAST.h"
-#include "ast/VariableExprAST.h"
+#include "ast/ASTArena.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/NumberExprAST.h"
+#include "ast/TypeScope.h"
 #include "kaleidoscope/kaleidoscope.h"
 
+#include <cmath>
+#include <cstdint>
+
 // Generate LLVM code for binary expressions
-llvm::Value *BinaryExprAST::codegen() {
+llvm::Value *BinaryExprAST::codegen(ScopedSymbolTable &NamedValues) {
   // Special case '=' because we don't want to emit the LHS as an expression.
   if (Op == '=')
   {
-    // This assume we're building without RTTI because LLVM builds that way by
-    // default. If you build LLVM with RTTI this can be changed to a
-    // dynamic_cast for automatic error checking.
-    VariableExprAST *LHSE = static_cast<VariableExprAST *>(LHS.get());
-    if (!LHSE)
-      return LogErrorV("destination of '=' must be a variable");
-
     // Codegen the RHS.
-    llvm::Value *Val = RHS->codegen();
+    llvm::Value *Val = RHS->codegen(NamedValues);
     if (!Val)
       return nullptr;
 
-    // Look up the name.
-    llvm::Value *Variable = NamedValues[LHSE->getName()];
-    if (!Variable)
-      return LogErrorV("Unknown variable name");
+    // typeCheck made sure the LHS is a variable or an array element
+    llvm::Value *Address = LHS->codegenAddress(NamedValues);
+    if (!Address)
+      return nullptr;
 
-    Builder.CreateStore(Val, Variable);
+    Builder.CreateStore(Val, Address);
     return Val;
   }
 
-  llvm::Value *L = LHS->codegen();
-  llvm::Value *R = RHS->codegen();
+  llvm::Value *L = LHS->codegen(NamedValues);
+  llvm::Value *R = RHS->codegen(NamedValues);
   if (!L || !R)
     return nullptr;
 
+  // The operator would only give back R, which typeCheck converted to its
+  // return type already
+  if (Sequencing)
+    return R;
+
+  // typeCheck has given both operands of a builtin operator the same type,
+  // which is never bool. i64 arithmetic wraps around, vectors are
+  // handled lane by lane
+  bool FP = isFloatingPoint(LHS->getType());
   switch (Op) {
   case '+':
-    return Builder.CreateFAdd(L, R, "addtmp");
+    return FP ? Builder.CreateFAdd(L, R, "addtmp") : Builder.CreateAdd(L, R, "addtmp");
   case '-':
-    return Builder.CreateFSub(L, R, "subtmp");
+    return FP ? Builder.CreateFSub(L, R, "subtmp") : Builder.CreateSub(L, R, "subtmp");
   case '*':
-    return Builder.CreateFMul(L, R, "multmp");
+    return FP ? Builder.CreateFMul(L, R, "multmp") : Builder.CreateMul(L, R, "multmp");
   case '<':
-    L = Builder.CreateFCmpULT(L, R, "cmptmp");
-    // Convert bool 0/1 to double 0.0 or 1.0
-    return Builder.CreateUIToFP(L, llvm::Type::getDoubleTy(TheContext), "booltmp");
+    if (isVector(Ty))
+      return Builder.CreateUIToFP(Builder.CreateFCmpULT(L, R, "cmptmp"),
+                                  getLLVMType(Ty), "booltmp");
+    return FP ? Builder.CreateFCmpULT(L, R, "cmptmp") : Builder.CreateICmpSLT(L, R, "cmptmp");
   default:
     break;
   }
 
   // If it wasn't a builtin binary operator, it must be a user defined one. Emit
   // a call to it.
-  llvm::Function *F = getFunction(std::string("binary") + Op);
+  llvm::Function *F = getFunction(getBinaryOpSymbol(Op));
   assert(F && "binary operator not found!");
 
   llvm::Value *Ops[2] = { L, R };
   return Builder.CreateCall(F, Ops, "binop");
-}
\ No newline at end of file
+}
+
+void BinaryExprAST::hash(ASTHasher &H) const {
+  H.add('b');
+  H.add(Op);
+  H.add(LHS);
+  H.add(RHS);
+  // User defined operators are calls, the builtin ones have no prototype
+  H.addCallee(getBinaryOpSymbol(Op));
+}
+
+// Computes L Op R on literals of type Ty as the instructions codegen emits
+// would: IEEE arithmetic for floats, in single precision for f32, and
+// wrapping arithmetic for i64. Comparisons give 1 or 0. False if there is
+// nothing to fold or the result is an i64 a double cannot hold exactly
+static bool foldBuiltin(char Op, ValueType Ty, double L, double R,
+                        double &Result) {
+  if (Ty == type_i64) {
+    // Overflow wraps around, as in unsigned arithmetic
+    uint64_t A = (uint64_t)(int64_t)L, B = (uint64_t)(int64_t)R;
+    int64_t V;
+    switch (Op) {
+    case '+':
+      V = (int64_t)(A + B);
+      break;
+    case '-':
+      V = (int64_t)(A - B);
+      break;
+    case '*':
+      V = (int64_t)(A * B);
+      break;
+    case '<':
+      Result = (int64_t)A < (int64_t)B ? 1.0 : 0.0;
+      return true;
+    default:
+      return false;
+    }
+    Result = (double)V;
+    return Result < 9223372036854775808.0 && (int64_t)Result == V;
+  }
+
+  switch (Op) {
+  case '+':
+    Result = L + R;
+    break;
+  case '-':
+    Result = L - R;
+    break;
+  case '*':
+    Result = L * R;
+    break;
+  case '<':
+    // codegen uses an unordered compare, which is true for NaNs
+    Result = !(L >= R) ? 1.0 : 0.0;
+    return true;
+  default:
+    return false;
+  }
+  // The exact sum, difference or product of two floats rounds to the same
+  // float whether or not it is rounded to a double first
+  if (Ty == type_f32)
+    Result = (float)Result;
+  return true;
+}
+
+ExprAST *BinaryExprAST::simplify() {
+  // Variables and array elements simplify to themselves, so the destination
+  // of '=' stays assignable
+  LHS = LHS->simplify();
+  RHS = RHS->simplify();
+
+  // User defined operators are calls, which are left to the inliner
+  if (Op != '+' && Op != '-' && Op != '*' && Op != '<')
+    return this;
+
+  // typeCheck converted both operands to the type Op computes in
+  ValueType OperandTy = LHS->getType();
+  double L, R, Result;
+  bool LConst = LHS->isConstant(L), RConst = RHS->isConstant(R);
+  if (LConst && RConst) {
+    if (foldBuiltin(Op, OperandTy, L, R, Result))
+      return TheASTArena.create<NumberExprAST>(Result, Ty);
+    return this;
+  }
+
+  // Only identities that hold for every operand, -0.0 and NaN included:
+  // x + 0.0 is +0.0 for x = -0.0 and x * 0.0 is NaN for infinities. Integers
+  // have a single zero
+  bool Float = OperandTy != type_i64;
+  ExprAST *Kept = nullptr;
+  switch (Op) {
+  case '+':
+    if (RConst && R == 0.0 && (!Float || std::signbit(R)))
+      Kept = LHS;
+    else if (LConst && L == 0.0 && (!Float || std::signbit(L)))
+      Kept = RHS;
+    break;
+  case '-':
+    if (RConst && R == 0.0 && (!Float || !std::signbit(R)))
+      Kept = LHS;
+    break;
+  case '*':
+    if (RConst && R == 1.0)
+      Kept = LHS;
+    else if (LConst && L == 1.0)
+      Kept = RHS;
+    break;
+  }
+
+  // The operand left standing must already be of the result's type, which a
+  // comparison's never is
+  if (Kept && Kept->getType() == Ty)
+    return Kept;
+  return this;
+}
+
+ExprAST *BinaryExprAST::typeCheck(TypeScope &Scope) {
+  LHS = LHS->typeCheck(Scope);
+  RHS = RHS->typeCheck(Scope);
+  if (!LHS || !RHS)
+    return nullptr;
+
+  // Assignments store and yield a value of the variable's type
+  if (Op == '=') {
+    if (!LHS->isAssignable())
+      return LogError("destination of '=' must be a variable or an array element");
+    // Variables live in the function's own frame, array elements do not
+    Symbol Var;
+    if (!LHS->isVariable(Var))
+      Scope.addMemoryEffect(memory_any);
+    RHS = convertTo(RHS, LHS->getType());
+    if (!RHS)
+      return nullptr;
+    Ty = LHS->getType();
+    return this;
+  }
+
+  switch (Op) {
+  case '+':
+  case '-':
+  case '*':
+  case '<': {
+    ValueType OperandTy;
+    if (!unifyTypes(LHS, RHS, OperandTy))
+      return nullptr;
+    if (isArray(OperandTy))
+      return LogError("Arrays can only be indexed, not used in arithmetic");
+    // Comparisons used to give 0.0 or 1.0, so bools compute as f64s
+    if (OperandTy == type_bool)
+      OperandTy = type_f64;
+    LHS = convertTo(LHS, OperandTy);
+    RHS = convertTo(RHS, OperandTy);
+    if (!LHS || !RHS)
+      return nullptr;
+    // Vectors compare lane by lane, giving 1.0 or 0.0 in every lane
+    Ty = Op == '<' && !isVector(OperandTy) ? type_bool : OperandTy;
+    return this;
+  }
+  default:
+    break;
+  }
+
+  // User defined operators take and return what their prototype says
+  const PrototypeAST *P = Scope.lookupFunction(getBinaryOpSymbol(Op));
+  if (!P)
+    return LogError("Unknown binary operator");
+  Scope.addCall(*P);
+  LHS = convertTo(LHS, P->getArgType(0));
+  RHS = convertTo(RHS, P->getArgType(1));
+  if (!LHS || !RHS)
+    return nullptr;
+  Ty = P->getReturnType();
+  Sequencing = P->isSequencing();
+  return this;
+}
+
+void BinaryExprAST::setTailPosition() {
+  if (Sequencing)
+    RHS->setTailPosition();
+}
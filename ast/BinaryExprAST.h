@@ -8,11 +8,18 @@
 // Expression class for a binary operator
 class BinaryExprAST : public ExprAST {
   char Op;
-  std::unique_ptr<ExprAST> LHS, RHS;
+  ExprAST *LHS, *RHS;
+  // Set by typeCheck for user defined sequencing operators, see
+  // PrototypeAST::isSequencing
+  bool Sequencing = false;
 
 public:
-  BinaryExprAST(char op, std::unique_ptr<ExprAST> LHS, std::unique_ptr<ExprAST> RHS) : Op(op), LHS(std::move(LHS)), RHS(std::move(RHS)) {}
-  llvm::Value *codegen() override;
+  BinaryExprAST(char op, ExprAST *LHS, ExprAST *RHS) : Op(op), LHS(LHS), RHS(RHS) {}
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  void setTailPosition() override;
 };
 
 #endif
@@ -0,0 +1,107 @@
+#include "ast/Builtins.h"
+#include "ast/CastExprAST.h"
+#include "kaleidoscope/kaleidoscope.h"
+#include "logger/logger.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSwitch.h"
+
+#include <string>
+
+Builtin lookupBuiltin(Symbol Name) {
+  return llvm::StringSwitch<Builtin>(Name.getName())
+      .Case("hadd", builtin_hadd)
+      .Case("hmul", builtin_hmul)
+      .Case("hmin", builtin_hmin)
+      .Case("hmax", builtin_hmax)
+      .Case("shuffle", builtin_shuffle)
+      .Default(builtin_none);
+}
+
+static bool typeCheckShuffle(llvm::MutableArrayRef<ExprAST *> Args,
+                             ValueType &Ty) {
+  if (Args.empty() || !isVector(Args[0]->getType())) {
+    LogError("shuffle expects a vector");
+    return false;
+  }
+
+  ValueType SourceTy = Args[0]->getType();
+  unsigned NumSources = 1;
+  if (Args.size() > 1 && Args[1]->getType() == SourceTy)
+    NumSources = 2;
+  unsigned NumLanes = getNumLanes(SourceTy) * NumSources;
+
+  if (!getVectorType(Args.size() - NumSources, Ty)) {
+    LogError("shuffle must pick 2, 4, 8 or 16 lanes");
+    return false;
+  }
+
+  // Lanes may be constant expressions like 1+1, which are folded here
+  // whether or not --simplify is on
+  for (ExprAST *&Lane : Args.drop_front(NumSources)) {
+    Lane = Lane->simplify();
+    double Val;
+    if (!Lane->isConstant(Val) || !Lane->setLiteralType(type_i64) ||
+        Val < 0 || Val >= NumLanes) {
+      std::string Msg = "shuffle lanes must be literals from 0 to " +
+                        std::to_string(NumLanes - 1);
+      LogError(Msg.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+bool typeCheckBuiltin(Builtin B, llvm::MutableArrayRef<ExprAST *> Args,
+                      ValueType &Ty) {
+  switch (B) {
+  case builtin_hadd:
+  case builtin_hmul:
+  case builtin_hmin:
+  case builtin_hmax:
+    if (Args.size() != 1 || !isVector(Args[0]->getType())) {
+      LogError("Horizontal reductions take a single vector");
+      return false;
+    }
+    Ty = type_f64;
+    return true;
+  case builtin_shuffle:
+    return typeCheckShuffle(Args, Ty);
+  case builtin_none:
+    break;
+  }
+  llvm_unreachable("not a builtin");
+}
+
+llvm::Value *emitBuiltin(Builtin B, llvm::ArrayRef<ExprAST *> Args,
+                         llvm::ArrayRef<llvm::Value *> ArgsV) {
+  switch (B) {
+  case builtin_hadd:
+    // Without reassociation this adds the lanes one after the other
+    return Builder.CreateFAddReduce(
+        llvm::ConstantFP::getNegativeZero(Builder.getDoubleTy()), ArgsV[0]);
+  case builtin_hmul:
+    return Builder.CreateFMulReduce(
+        llvm::ConstantFP::get(Builder.getDoubleTy(), 1.0), ArgsV[0]);
+  case builtin_hmin:
+    return Builder.CreateFPMinReduce(ArgsV[0]);
+  case builtin_hmax:
+    return Builder.CreateFPMaxReduce(ArgsV[0]);
+  case builtin_shuffle: {
+    unsigned NumSources = Args.size() > 1 && isVector(Args[1]->getType()) ? 2 : 1;
+    llvm::SmallVector<int, 16> Mask;
+    for (const ExprAST *Lane : Args.drop_front(NumSources)) {
+      double Val;
+      Lane->isConstant(Val);
+      Mask.push_back((int)Val);
+    }
+    llvm::Value *Second = NumSources == 2
+                              ? ArgsV[1]
+                              : llvm::PoisonValue::get(ArgsV[0]->getType());
+    return Builder.CreateShuffleVector(ArgsV[0], Second, Mask, "shuffletmp");
+  }
+  case builtin_none:
+    break;
+  }
+  llvm_unreachable("not a builtin");
+}
@@ -0,0 +1,39 @@
+#ifndef __BUILTINS_H__
+#define __BUILTINS_H__
+
+#include "ast/ExprAST.h"
+#include "lexer/symbol.h"
+
+// Functions the compiler provides itself, they are called like any other
+// function. A user function of the same name takes precedence once it has
+// been declared
+enum Builtin
+{
+  builtin_none,
+
+  // Horizontal reductions of a vector to an f64: the sum and product in
+  // lane order, and the smallest and largest lane ignoring NaNs
+  builtin_hadd,
+  builtin_hmul,
+  builtin_hmin,
+  builtin_hmax,
+
+  // shuffle(v, i, j, ...) builds a vector of lanes v[i], v[j], ...;
+  // shuffle(a, b, i, j, ...) picks from the lanes of a followed by those of
+  // b. The lane numbers must be literals
+  builtin_shuffle
+};
+
+// The builtin called Name, or builtin_none
+Builtin lookupBuiltin(Symbol Name);
+
+// Checks a call to B whose arguments have been type checked themselves and
+// sets Ty to its result. Returns false after logging a type error
+bool typeCheckBuiltin(Builtin B, llvm::MutableArrayRef<ExprAST *> Args,
+                      ValueType &Ty);
+
+// Generates a call to B, given the AST and the values of its arguments
+llvm::Value *emitBuiltin(Builtin B, llvm::ArrayRef<ExprAST *> Args,
+                         llvm::ArrayRef<llvm::Value *> ArgsV);
+
+#endif
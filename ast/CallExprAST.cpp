@@ -1,7 +1,20 @@
 #include "ast/CallExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
 
 // Generate LLVM code for function calls
-llvm::Value *CallExprAST::codegen() {
+llvm::Value *CallExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  if (BuiltinFn != builtin_none) {
+    std::vector<llvm::Value *> ArgsV;
+    for (ExprAST *Arg : Args) {
+      ArgsV.push_back(Arg->codegen(NamedValues));
+      if (!ArgsV.back())
+        return nullptr;
+    }
+    return emitBuiltin(BuiltinFn, Args, ArgsV);
+  }
+
   llvm::Function *CalleeF = getFunction(Callee);
 
   if (!CalleeF) {
@@ -14,12 +27,74 @@ llvm::Value *CallExprAST::codegen() {
 
   std::vector<llvm::Value *> ArgsV;
   for (unsigned i = 0, e = Args.size(); i != e; i++) {
-    ArgsV.push_back(Args[i]->codegen());
+    ArgsV.push_back(Args[i]->codegen(NamedValues));
 
     if (!ArgsV.back()) {
       return nullptr;
     }
   }
 
-  return Builder.CreateCall(CalleeF, ArgsV, "calltmp");
+  llvm::CallInst *Call = Builder.CreateCall(CalleeF, ArgsV, "calltmp");
+
+  // Nothing but a ret follows a call in tail position, see
+  // ExprAST::setTailPosition. Its frame can then be reused whenever the
+  // callee has the caller's signature, which covers every recursive call,
+  // even at -O0; other calls are left to the backend to turn into jumps
+  if (IsTail) {
+    llvm::Function *Caller = Builder.GetInsertBlock()->getParent();
+    bool SameSignature =
+        CalleeF->getFunctionType() == Caller->getFunctionType() &&
+        CalleeF->getCallingConv() == Caller->getCallingConv();
+    Call->setTailCallKind(SameSignature ? llvm::CallInst::TCK_MustTail
+                                        : llvm::CallInst::TCK_Tail);
+  }
+  return Call;
+}
+
+void CallExprAST::hash(ASTHasher &H) const {
+  H.add('c');
+  H.add(Callee);
+  H.add((unsigned)Args.size());
+  for (const ExprAST *Arg : Args)
+    H.add(Arg);
+  H.addCallee(Callee);
+}
+
+ExprAST *CallExprAST::simplify() {
+  for (ExprAST *&Arg : Args)
+    Arg = Arg->simplify();
+  return this;
+}
+
+ExprAST *CallExprAST::typeCheck(TypeScope &Scope) {
+  const PrototypeAST *P = Scope.lookupFunction(Callee);
+  if (!P && (BuiltinFn = lookupBuiltin(Callee)) != builtin_none) {
+    for (ExprAST *&Arg : Args) {
+      Arg = Arg->typeCheck(Scope);
+      if (!Arg)
+        return nullptr;
+    }
+    if (!typeCheckBuiltin(BuiltinFn, Args, Ty))
+      return nullptr;
+    return this;
+  }
+  if (!P)
+    return LogError("Unknown function referenced");
+  if (P->getArgs().size() != Args.size())
+    return LogError("Incorrect # arguments passed");
+  if (P == Scope.getFunction())
+    Scope.addRecursiveCall(this);
+  Scope.addCall(*P);
+
+  for (unsigned i = 0, e = Args.size(); i != e; i++) {
+    Args[i] = Args[i]->typeCheck(Scope);
+    if (!Args[i])
+      return nullptr;
+    Args[i] = convertTo(Args[i], P->getArgType(i));
+    if (!Args[i])
+      return nullptr;
+  }
+
+  Ty = P->getReturnType();
+  return this;
 }
@@ -1,6 +1,7 @@
 #ifndef __CALL_EXPR_AST_H__
 #define __CALL_EXPR_AST_H__
 
+#include "ast/Builtins.h"
 #include "ast/ExprAST.h"
 #include "llvm/IR/IRBuilder.h"
 #include "logger/logger.h"
@@ -8,12 +9,22 @@
 
 // Expression class for function calls
 class CallExprAST : public ExprAST {
-  std::string Callee;
-  std::vector<std::unique_ptr<ExprAST>> Args;
+  Symbol Callee;
+  llvm::MutableArrayRef<ExprAST *> Args;
+  // Set by typeCheck if Callee is one of the builtins
+  Builtin BuiltinFn = builtin_none;
+  // Set by setTailPosition
+  bool IsTail = false;
 
 public:
-  CallExprAST(const std::string &Callee, std::vector<std::unique_ptr<ExprAST>> Args) : Callee(Callee), Args(std::move(Args)) {}
-  llvm::Value *codegen() override;
+  // Args must live in TheASTArena
+  CallExprAST(Symbol Callee, llvm::MutableArrayRef<ExprAST *> Args) : Callee(Callee), Args(Args) {}
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  void setTailPosition() override { IsTail = BuiltinFn == builtin_none; }
+  bool isTailCall() const { return IsTail; }
 };
 
 #endif
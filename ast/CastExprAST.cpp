@@ -0,0 +1,123 @@
+#include "ast/CastExprAST.h"
+#include "ast/ASTArena.h"
+#include "ast/ASTHasher.h"
+#include "ast/NumberExprAST.h"
+#include "logger/logger.h"
+
+#include <cmath>
+#include <string>
+
+llvm::Value *CastExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  llvm::Value *V = Operand->codegen(NamedValues);
+  if (!V)
+    return nullptr;
+  return emitConversion(V, Operand->getType(), Ty, "casttmp");
+}
+
+void CastExprAST::hash(ASTHasher &H) const {
+  H.add('C');
+  H.add((unsigned)Ty);
+  H.add(Operand);
+}
+
+ExprAST *CastExprAST::simplify() {
+  Operand = Operand->simplify();
+
+  // Converts a literal as emitConversion would at run time
+  double Val;
+  if (!Operand->isConstant(Val))
+    return this;
+  // Integers have no -0.0 to carry over
+  if (!isFloatingPoint(Operand->getType()))
+    Val += 0.0;
+  switch (Ty) {
+  case type_f64:
+  case type_vec2:
+  case type_vec4:
+  case type_vec8:
+  case type_vec16:
+    break;
+  case type_f32:
+    Val = (float)Val;
+    break;
+  case type_i64:
+    // NaN converts to 0, values out of range saturate to limits a double
+    // cannot hold, which are left to codegen
+    Val = std::isnan(Val) ? 0.0 : std::trunc(Val) + 0.0;
+    if (!(Val >= -9223372036854775808.0 && Val < 9223372036854775808.0))
+      return this;
+    break;
+  case type_bool:
+    Val = Val != 0.0 && !std::isnan(Val) ? 1.0 : 0.0;
+    break;
+  default:
+    return this;
+  }
+  return TheASTArena.create<NumberExprAST>(Val, Ty);
+}
+
+ExprAST *CastExprAST::typeCheck(TypeScope &Scope) {
+  Operand = Operand->typeCheck(Scope);
+  if (!Operand)
+    return nullptr;
+
+  // There is nothing left to do at run time if the operand already is of
+  // the right type
+  if (Operand->getType() == Ty || Operand->setLiteralType(Ty))
+    return Operand;
+  if (!isExplicitlyConvertible(Operand->getType(), Ty)) {
+    std::string Msg = std::string("Cannot convert ") +
+                      getTypeName(Operand->getType()) + " to " +
+                      getTypeName(Ty);
+    return LogError(Msg.c_str());
+  }
+  return this;
+}
+
+bool isImplicitlyConvertible(ValueType From, ValueType To) {
+  if (From == To)
+    return true;
+  if (!isScalar(From) || isArray(To))
+    return false;
+  if (From == type_bool || isVector(To))
+    return true;
+  return To == type_f64 && (From == type_i64 || From == type_f32);
+}
+
+bool isExplicitlyConvertible(ValueType From, ValueType To) {
+  return From == To || (isScalar(From) && !isArray(To));
+}
+
+ExprAST *convertTo(ExprAST *E, ValueType To) {
+  if (E->getType() == To || E->setLiteralType(To))
+    return E;
+  if (isImplicitlyConvertible(E->getType(), To))
+    return TheASTArena.create<CastExprAST>(To, E);
+
+  std::string Msg = std::string("Type mismatch: expected ") + getTypeName(To) +
+                    ", found " + getTypeName(E->getType());
+  if (isExplicitlyConvertible(E->getType(), To))
+    Msg += std::string(", convert with 'as ") + getTypeName(To) + "'";
+  return LogError(Msg.c_str());
+}
+
+bool unifyTypes(ExprAST *L, ExprAST *R, ValueType &Ty) {
+  ValueType LTy = L->getType(), RTy = R->getType();
+  if (LTy == RTy || R->setLiteralType(LTy))
+    Ty = LTy;
+  else if (L->setLiteralType(RTy))
+    Ty = RTy;
+  else if (isImplicitlyConvertible(LTy, RTy))
+    Ty = RTy;
+  else if (isImplicitlyConvertible(RTy, LTy))
+    Ty = LTy;
+  else if (isScalar(LTy) && isScalar(RTy))
+    Ty = type_f64;
+  else {
+    std::string Msg = std::string("Type mismatch between ") + getTypeName(LTy) +
+                      " and " + getTypeName(RTy);
+    LogError(Msg.c_str());
+    return false;
+  }
+  return true;
+}
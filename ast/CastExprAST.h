@@ -0,0 +1,41 @@
+#ifndef __CAST_EXPR_AST_H__
+#define __CAST_EXPR_AST_H__
+
+#include "ast/ExprAST.h"
+#include "kaleidoscope/kaleidoscope.h"
+
+// Expression class for conversions like "x as i64". Type checking adds one
+// wherever a value is implicitly converted
+class CastExprAST : public ExprAST {
+  ExprAST *Operand;
+
+public:
+  CastExprAST(ValueType To, ExprAST *Operand) : Operand(Operand) { Ty = To; }
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+};
+
+// Whether a From may be used where a To is expected without 'as': bools
+// widen to any number, i64 and f32 to f64 and scalars to vectors. Nothing
+// is narrowed implicitly
+bool isImplicitlyConvertible(ValueType From, ValueType To);
+
+// Whether 'as' can convert a From to a To: any scalar to any scalar or
+// vector, but vectors and arrays only to themselves
+bool isExplicitlyConvertible(ValueType From, ValueType To);
+
+// Returns E, which has been type checked, as an expression of type To: E
+// itself, E retyped if it is a literal To holds exactly, or an implicit
+// cast. Anything else is a type error, which is logged and gives null
+ExprAST *convertTo(ExprAST *E, ValueType To);
+
+// Finds the type two type checked operands are converted to for builtin
+// binary operators and the branches of an if. A literal takes on the type
+// of the other operand if that holds it exactly, otherwise the wider type
+// wins, and i64 and f32 meet in f64. Returns false after logging a type
+// error for vectors of different widths
+bool unifyTypes(ExprAST *L, ExprAST *R, ValueType &Ty);
+
+#endif
@@ -2,11 +2,64 @@
 #define __EXPR_AST_H__
 
 #include "llvm/IR/BasicBlock.h"
+#include "kaleidoscope/symboltable.h"
+#include "kaleidoscope/types.h"
 
+class ASTHasher;
+class TypeScope;
+
+// Nodes live in TheASTArena and are released with it, never deleted on their
+// own, so the destructor is not virtual and not public
 class ExprAST {
 public:
-  virtual ~ExprAST() {}
-  virtual llvm::Value *codegen() = 0;
+  virtual llvm::Value *codegen(ScopedSymbolTable &NamedValues) = 0;
+
+  // Adds the node and its children to H, see ASTHasher
+  virtual void hash(ASTHasher &H) const = 0;
+
+  // Folds constants and IEEE-safe identities in the type checked subtree
+  // and returns the node to use in its place: this one, one of its children
+  // or a new node in TheASTArena, always of this node's type. Nothing is
+  // folded that would change what the program computes, including the sign
+  // of zeros, NaNs and i64 overflow
+  virtual ExprAST *simplify() = 0;
+
+  // True for literals, with their value in Val
+  virtual bool isConstant(double &Val) const { return false; }
+
+  // True for variable references, with the variable in Name
+  virtual bool isVariable(Symbol &Name) const { return false; }
+
+  // Works out the type of every node in the subtree and returns the node to
+  // generate in its place, normally this one with its children converted to
+  // the types it needs (see convertTo in ast/CastExprAST.h), or null after
+  // logging a type error. simplify and codegen rely on it
+  virtual ExprAST *typeCheck(TypeScope &Scope) = 0;
+
+  // The type of the value codegen produces
+  ValueType getType() const { return Ty; }
+
+  // Makes a literal of type To, as long as To holds its value exactly
+  virtual bool setLiteralType(ValueType To) { return false; }
+
+  // Whether '=' can store to the node, known once it is type checked
+  virtual bool isAssignable() const { return false; }
+
+  // Generates the address '=' stores to, only called if isAssignable
+  virtual llvm::Value *codegenAddress(ScopedSymbolTable &NamedValues) {
+    return nullptr;
+  }
+
+  // Tells a type checked node that the function returns its value as it
+  // is. Calls there become tail calls, and nodes whose value is that of a
+  // child (if, var, sequencing operators) pass it on. codegen may then end
+  // blocks with a ret of its own, the caller returns the value it gives
+  virtual void setTailPosition() {}
+
+protected:
+  ~ExprAST() = default;
+
+  ValueType Ty = type_f64;
 };
 
 #endif
@@ -1,13 +1,18 @@
 #include "ast/ForExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
+#include "logger/logger.h"
 #include "kaleidoscope/kaleidoscope.h"
 
 /// CreateEntryBlockAlloca - Create an alloca instruction in the entry block of
 /// the function.  This is used for mutable variables etc.
 static llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction,
-                                          const std::string &VarName) {
+                                          llvm::StringRef VarName,
+                                          llvm::Type *Ty) {
   llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(),
                  TheFunction->getEntryBlock().begin());
-  return TmpB.CreateAlloca(llvm::Type::getDoubleTy(TheContext), nullptr, VarName.c_str());
+  return TmpB.CreateAlloca(Ty, nullptr, VarName);
 }
 
 // Output for-loop as:
@@ -25,14 +30,15 @@ static llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction,
 //   endcond = endexpr
 //   br endcond, loop, endloop
 // outloop:
-llvm::Value *ForExprAST::codegen() {
+llvm::Value *ForExprAST::codegen(ScopedSymbolTable &NamedValues) {
   llvm::Function *TheFunction = Builder.GetInsertBlock()->getParent();
 
   // Create an alloca for the variable in the entry block.
-  llvm::AllocaInst *Alloca = CreateEntryBlockAlloca(TheFunction, VarName);
+  llvm::AllocaInst *Alloca =
+      CreateEntryBlockAlloca(TheFunction, VarName.getName(), getLLVMType(VarType));
 
   // Emit the start code first, without 'variable' in scope.
-  llvm::Value *StartVal = Start->codegen();
+  llvm::Value *StartVal = Start->codegen(NamedValues);
   if (!StartVal)
     return nullptr;
 
@@ -49,43 +55,45 @@ llvm::Value *ForExprAST::codegen() {
   // Start insertion in LoopBB.
   Builder.SetInsertPoint(LoopBB);
 
-  // Within the loop, the variable is defined equal to the PHI node.  If it
-  // shadows an existing variable, we have to restore it, so save it now.
-  llvm::AllocaInst *OldVal = NamedValues[VarName];
-  NamedValues[VarName] = Alloca;
+  // Within the loop, the variable is defined equal to the PHI node.  It lives
+  // in a scope of its own, so that any variable it shadows comes back when
+  // the scope is popped.
+  NamedValues.pushScope();
+  NamedValues.bind(VarName, Alloca);
 
   // Emit the body of the loop.  This, like any other expr, can change the
   // current BB.  Note that we ignore the value computed by the body, but don't
   // allow an error.
-  if (!Body->codegen())
+  if (!Body->codegen(NamedValues))
     return nullptr;
 
   // Emit the step value.
   llvm::Value *StepVal = nullptr;
   if (Step) {
-    StepVal = Step->codegen();
+    StepVal = Step->codegen(NamedValues);
     if (!StepVal)
       return nullptr;
   } else {
-    // If not specified, use 1.0.
-    StepVal = llvm::ConstantFP::get(TheContext, llvm::APFloat(1.0));
+    // If not specified, use 1.
+    StepVal = getConstant(VarType, 1.0);
   }
 
   // Compute the end condition.
-  llvm::Value *EndCond = End->codegen();
+  llvm::Value *EndCond = End->codegen(NamedValues);
   if (!EndCond)
     return nullptr;
 
   // Reload, increment, and restore the alloca.  This handles the case where
   // the body of the loop mutates the variable.
   llvm::Value *CurVar =
-      Builder.CreateLoad(Alloca->getAllocatedType(), Alloca, VarName.c_str());
-  llvm::Value *NextVar = Builder.CreateFAdd(CurVar, StepVal, "nextvar");
+      Builder.CreateLoad(Alloca->getAllocatedType(), Alloca, VarName.getName());
+  llvm::Value *NextVar = isFloatingPoint(VarType)
+                             ? Builder.CreateFAdd(CurVar, StepVal, "nextvar")
+                             : Builder.CreateAdd(CurVar, StepVal, "nextvar");
   Builder.CreateStore(NextVar, Alloca);
 
-  // Convert condition to a bool by comparing non-equal to 0.0.
-  EndCond = Builder.CreateFCmpONE(
-      EndCond, llvm::ConstantFP::get(TheContext, llvm::APFloat(0.0)), "loopcond");
+  // Convert condition to a bool by comparing non-equal to 0.
+  EndCond = emitConversion(EndCond, End->getType(), type_bool, "loopcond");
 
   // Create the "after loop" block and insert it.
   llvm::BasicBlock *AfterBB =
@@ -98,11 +106,68 @@ llvm::Value *ForExprAST::codegen() {
   Builder.SetInsertPoint(AfterBB);
 
   // Restore the unshadowed variable.
-  if (OldVal)
-    NamedValues[VarName] = OldVal;
-  else
-    NamedValues.erase(VarName);
+  NamedValues.popScope();
 
   // for expr always returns 0.0.
   return llvm::Constant::getNullValue(llvm::Type::getDoubleTy(TheContext));
-}
\ No newline at end of file
+}
+
+void ForExprAST::hash(ASTHasher &H) const {
+  H.add('f');
+  H.add(VarName);
+  H.add((unsigned)VarType);
+  H.add(Start);
+  H.add(End);
+  H.add(Step);
+  H.add(Body);
+}
+
+ExprAST *ForExprAST::simplify() {
+  // The loop is kept even when the end condition is constant, it still has
+  // to run the body and yields 0.0 either way
+  Start = Start->simplify();
+  End = End->simplify();
+  if (Step)
+    Step = Step->simplify();
+  Body = Body->simplify();
+  return this;
+}
+
+ExprAST *ForExprAST::typeCheck(TypeScope &Scope) {
+  Start = Start->typeCheck(Scope);
+  if (!Start)
+    return nullptr;
+
+  // Without an annotation the variable takes the type of its start value,
+  // counting with bools is done in f64 like anywhere else
+  if (VarType == type_inferred)
+    VarType = Start->getType() == type_bool ? type_f64 : Start->getType();
+  if (VarType == type_bool || !isScalar(VarType))
+    return LogError("The variable of a for loop must be a scalar number");
+  Start = convertTo(Start, VarType);
+  if (!Start)
+    return nullptr;
+
+  Scope.pushScope();
+  Scope.bind(VarName, VarType);
+  Scope.addLoop();
+
+  // The end condition may be of any scalar type, the step must fit the variable
+  Body = Body->typeCheck(Scope);
+  End = End->typeCheck(Scope);
+  bool StepOK = true;
+  if (Step) {
+    Step = Step->typeCheck(Scope);
+    Step = Step ? convertTo(Step, VarType) : nullptr;
+    StepOK = Step != nullptr;
+  }
+  Scope.popScope();
+  if (!Body || !End || !StepOK)
+    return nullptr;
+  if (!isScalar(End->getType()))
+    return LogError("The end condition of a for loop must be a scalar");
+
+  // for expr always returns 0.0.
+  Ty = type_f64;
+  return this;
+}
@@ -3,20 +3,26 @@
 
 #include "ast/ExprAST.h"
 #include "llvm/IR/IRBuilder.h"
+#include "lexer/symbol.h"
 
 /// ForExprAST - Expression class for for/in.
 class ForExprAST : public ExprAST {
-  std::string VarName;
-  std::unique_ptr<ExprAST> Start, End, Step, Body;
+  Symbol VarName;
+  // type_inferred until typeCheck if there is no annotation
+  ValueType VarType;
+  ExprAST *Start, *End, *Step, *Body;
 
 public:
-  ForExprAST(const std::string &VarName, std::unique_ptr<ExprAST> Start,
-             std::unique_ptr<ExprAST> End, std::unique_ptr<ExprAST> Step,
-             std::unique_ptr<ExprAST> Body)
-      : VarName(VarName), Start(std::move(Start)), End(std::move(End)),
-        Step(std::move(Step)), Body(std::move(Body)) {}
+  // Step may be null
+  ForExprAST(Symbol VarName, ValueType VarType, ExprAST *Start, ExprAST *End,
+             ExprAST *Step, ExprAST *Body)
+      : VarName(VarName), VarType(VarType), Start(Start), End(End), Step(Step),
+        Body(Body) {}
 
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
 };
 
 #endif
\ No newline at end of file
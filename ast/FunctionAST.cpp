@@ -1,53 +1,81 @@
 #include "ast/FunctionAST.h"
 #include "parser/parser.h"
+#include "optimizer/optimizer.h"
+#include "stats/stats.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
 
 /// CreateEntryBlockAlloca - Create an alloca instruction in the entry block of
 /// the function.  This is used for mutable variables etc.
 static llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction,
-                                          const std::string &VarName) {
+                                          llvm::StringRef VarName,
+                                          llvm::Type *Ty) {
   llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(),
                  TheFunction->getEntryBlock().begin());
-  return TmpB.CreateAlloca(llvm::Type::getDoubleTy(TheContext), nullptr, VarName.c_str());
+  return TmpB.CreateAlloca(Ty, nullptr, VarName);
 }
 
-// Generates LLVM code for functions declarations
-llvm::Function *FunctionAST::codegen() {
+void FunctionAST::declare() {
+  if (Declared)
+    return;
+
   // Transfer ownership of the prototype to the FunctionProtos map, but keep a
-  // reference to it for use below.
-  auto &P = *Proto;
-  FunctionProtos[Proto->getName()] = std::move(Proto);
+  // reference to it for codegen.
+  Declared = Proto.get();
+  (*FunctionProtos)[Proto->getName()] = std::move(Proto);
+
+  // If this is an operator, install it.
+  if (Declared->isBinaryOp())
+    BinopPrecedence[Declared->getOperatorName()] = Declared->getBinaryPrecedence();
+}
+
+// Generates LLVM code for functions declarations
+llvm::Function *FunctionAST::codegen(ScopedSymbolTable &NamedValues) {
+  // Functions declared up front may be generated on any thread, which must
+  // leave the shared FunctionProtos and BinopPrecedence alone
+  bool DeclaredHere = !Declared;
+  if (DeclaredHere)
+    declare();
+
+  auto &P = *Declared;
   llvm::Function *TheFunction = getFunction(P.getName());
   if (!TheFunction)
     return nullptr;
 
-  // If this is an operator, install it.
-  if (P.isBinaryOp())
-    BinopPrecedence[P.getOperatorName()] = P.getBinaryPrecedence();
-
 
   // Create a new basic block to start insertion into.
   llvm::BasicBlock *BB = llvm::BasicBlock::Create(TheContext, "entry", TheFunction);
   Builder.SetInsertPoint(BB);
 
-  // Record the function arguments in the NamedValues map.
+  // Record the function arguments in the outermost scope of NamedValues.
   NamedValues.clear();
+  const std::vector<Symbol> &ArgNames = P.getArgs();
   for (auto &Arg : TheFunction->args()) {
     // Create an alloca for this variable.
-    llvm::AllocaInst *Alloca = CreateEntryBlockAlloca(TheFunction, Arg.getName());
+    llvm::AllocaInst *Alloca =
+        CreateEntryBlockAlloca(TheFunction, Arg.getName(), Arg.getType());
 
     // Store the initial value into the alloca.
     Builder.CreateStore(&Arg, Alloca);
 
     // Add arguments to variable symbol table.
-    NamedValues[std::string(Arg.getName())] = Alloca;
+    NamedValues.bind(ArgNames[Arg.getArgNo()], Alloca);
   }
 
-  if (llvm::Value *RetVal = Body->codegen()) {
+  // The body is in tail position, see ExprAST::setTailPosition
+  if (llvm::Value *RetVal = Body->codegen(NamedValues)) {
     // Finish off the function.
     Builder.CreateRet(RetVal);
 
     // Validate the generated code, checking for consistency.
-    verifyFunction(*TheFunction);
+    {
+      PhaseTimer Timer(phase_verify);
+      verifyFunction(*TheFunction);
+    }
+
+    // Clean up the function now, while it is still small and hot in cache.
+    OptimizeFunction(*TheFunction);
 
     return TheFunction;
   }
@@ -55,7 +83,48 @@ llvm::Function *FunctionAST::codegen() {
   // Error reading body, remove function.
   TheFunction->eraseFromParent();
 
-  if (P.isBinaryOp())
+  if (DeclaredHere && P.isBinaryOp())
     BinopPrecedence.erase(P.getOperatorName());
   return nullptr;
 }
+
+void FunctionAST::hash(ASTHasher &H) const {
+  H.add(Declared ? *Declared : *Proto);
+  H.add(Body);
+}
+
+bool FunctionAST::typeCheck(TypeScope &Scope) {
+  PrototypeAST &P = Declared ? *Declared : *Proto;
+  Scope.reset(P);
+
+  ExprAST *Checked = Body->typeCheck(Scope);
+  if (!Checked)
+    return false;
+  Checked = convertTo(Checked, P.getReturnType());
+  if (!Checked)
+    return false;
+  Body = Checked;
+  Body->setTailPosition();
+
+  // A pure function only gets to promise that it returns, its memory
+  // effects are what the body does
+  MemoryEffects Memory = Scope.getMemoryEffects();
+  if (P.isPure() && Memory == memory_any) {
+    LogError("A pure function cannot write arrays or call functions that may "
+             "have side effects");
+    return false;
+  }
+  P.setEffects(Memory, P.isPure() || Scope.willReturn());
+
+  // Without a conversion in the way the body is the right operand itself
+  Symbol Var;
+  P.setSequencing(P.isBinaryOp() && Body->isVariable(Var) &&
+                  Var == P.getArgs()[1]);
+  return true;
+}
+
+void FunctionAST::simplify() {
+  Body = Body->simplify();
+  // What is left of x * 1 may be a call in tail position
+  Body->setTailPosition();
+}
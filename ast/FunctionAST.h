@@ -3,14 +3,40 @@
 
 #include "ast/PrototypeAST.h"
 
+class TypeScope;
+
 // Represents a function definition itself
 class FunctionAST {
   std::unique_ptr<PrototypeAST> Proto;
-  std::unique_ptr<ExprAST> Body;
+  // The prototype once it has been handed over to FunctionProtos
+  PrototypeAST *Declared = nullptr;
+  ExprAST *Body;
 
 public:
-  FunctionAST(std::unique_ptr<PrototypeAST> Proto, std::unique_ptr<ExprAST> Body) : Proto(std::move(Proto)), Body(std::move(Body)) {}
-  llvm::Function *codegen();
+  FunctionAST(std::unique_ptr<PrototypeAST> Proto, ExprAST *Body) : Proto(std::move(Proto)), Body(Body) {}
+
+  // Moves the prototype to FunctionProtos, where calls look it up, and
+  // installs the precedence of a binary operator. codegen does this itself
+  // unless it has been done up front, which is how functions generated on
+  // worker threads are declared before any of them runs. Calling it again
+  // does nothing
+  void declare();
+
+  Symbol getName() const {
+    return Declared ? Declared->getName() : Proto->getName();
+  }
+
+  // Checks the types of the body, see ExprAST::typeCheck. Must be called
+  // before simplify and codegen, returns false after logging a type error
+  bool typeCheck(TypeScope &Scope);
+
+  // Folds constants in the type checked body, see ExprAST::simplify
+  void simplify();
+
+  llvm::Function *codegen(ScopedSymbolTable &NamedValues);
+
+  // Adds the prototype and the body to H, see ASTHasher
+  void hash(ASTHasher &H) const;
 };
 
 #endif
@@ -6,14 +6,20 @@
 
 /// IfExprAST - Expression class for if/then/else.
 class IfExprAST : public ExprAST {
-  std::unique_ptr<ExprAST> Cond, Then, Else;
+  ExprAST *Cond, *Then, *Else;
+  // Set by setTailPosition, codegen then returns the value of Then right
+  // away and leaves that of Else to the caller
+  bool IsTail = false;
 
 public:
-  IfExprAST(std::unique_ptr<ExprAST> Cond, std::unique_ptr<ExprAST> Then,
-            std::unique_ptr<ExprAST> Else)
-    : Cond(std::move(Cond)), Then(std::move(Then)), Else(std::move(Else)) {}
+  IfExprAST(ExprAST *Cond, ExprAST *Then, ExprAST *Else)
+    : Cond(Cond), Then(Then), Else(Else) {}
 
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  void setTailPosition() override;
 };
 
 #endif
\ No newline at end of file
@@ -1,14 +1,19 @@
 #include "ast/IfExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
+#include "logger/logger.h"
 #include "kaleidoscope/kaleidoscope.h"
 
-llvm::Value *IfExprAST::codegen() {
-  llvm::Value *CondV = Cond->codegen();
+#include <cmath>
+
+llvm::Value *IfExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  llvm::Value *CondV = Cond->codegen(NamedValues);
   if (!CondV)
     return nullptr;
 
-  // Convert condition to a bool by comparing non-equal to 0.0.
-  CondV = Builder.CreateFCmpONE(
-      CondV, llvm::ConstantFP::get(TheContext, llvm::APFloat(0.0)), "ifcond");
+  // Convert condition to a bool by comparing non-equal to 0.
+  CondV = emitConversion(CondV, Cond->getType(), type_bool, "ifcond");
 
   llvm::Function *TheFunction = Builder.GetInsertBlock()->getParent();
 
@@ -16,17 +21,27 @@ llvm::Value *IfExprAST::codegen() {
   // end of the function.
   llvm::BasicBlock *ThenBB = llvm::BasicBlock::Create(TheContext, "then", TheFunction);
   llvm::BasicBlock *ElseBB = llvm::BasicBlock::Create(TheContext, "else", TheFunction);
-  llvm::BasicBlock *MergeBB = llvm::BasicBlock::Create(TheContext, "ifcont", TheFunction);
+  llvm::BasicBlock *MergeBB =
+      IsTail ? nullptr : llvm::BasicBlock::Create(TheContext, "ifcont", TheFunction);
 
   Builder.CreateCondBr(CondV, ThenBB, ElseBB);
 
   // Emit then value.
   Builder.SetInsertPoint(ThenBB);
 
-  llvm::Value *ThenV = Then->codegen();
+  llvm::Value *ThenV = Then->codegen(NamedValues);
   if (!ThenV)
     return nullptr;
 
+  // In tail position both branches return on their own, so that a call in
+  // either of them is followed by nothing but its ret. The caller returns
+  // the value of the else branch
+  if (IsTail) {
+    Builder.CreateRet(ThenV);
+    Builder.SetInsertPoint(ElseBB);
+    return Else->codegen(NamedValues);
+  }
+
   Builder.CreateBr(MergeBB);
   // Codegen of 'Then' can change the current block, update ThenBB for the PHI.
   ThenBB = Builder.GetInsertBlock();
@@ -34,7 +49,7 @@ llvm::Value *IfExprAST::codegen() {
   // Emit else block.
   Builder.SetInsertPoint(ElseBB);
 
-  llvm::Value *ElseV = Else->codegen();
+  llvm::Value *ElseV = Else->codegen(NamedValues);
   if (!ElseV)
     return nullptr;
 
@@ -44,9 +59,54 @@ llvm::Value *IfExprAST::codegen() {
 
   // Emit merge block.
   Builder.SetInsertPoint(MergeBB);
-  llvm::PHINode *PN = Builder.CreatePHI(llvm::Type::getDoubleTy(TheContext), 2, "iftmp");
+  llvm::PHINode *PN = Builder.CreatePHI(getLLVMType(Ty), 2, "iftmp");
 
   PN->addIncoming(ThenV, ThenBB);
   PN->addIncoming(ElseV, ElseBB);
   return PN;
-}
\ No newline at end of file
+}
+
+void IfExprAST::hash(ASTHasher &H) const {
+  H.add('i');
+  H.add(Cond);
+  H.add(Then);
+  H.add(Else);
+}
+
+ExprAST *IfExprAST::simplify() {
+  Cond = Cond->simplify();
+  Then = Then->simplify();
+  Else = Else->simplify();
+
+  // codegen branches on an ordered compare with 0.0, so NaN takes the else
+  // branch as well. typeCheck converted both branches to the if's type
+  double C;
+  if (Cond->isConstant(C))
+    return (C != 0.0 && !std::isnan(C)) ? Then : Else;
+  return this;
+}
+
+void IfExprAST::setTailPosition() {
+  IsTail = true;
+  Then->setTailPosition();
+  Else->setTailPosition();
+}
+
+ExprAST *IfExprAST::typeCheck(TypeScope &Scope) {
+  // Conditions may be of any scalar type
+  Cond = Cond->typeCheck(Scope);
+  Then = Then->typeCheck(Scope);
+  Else = Else->typeCheck(Scope);
+  if (!Cond || !Then || !Else)
+    return nullptr;
+
+  if (!isScalar(Cond->getType()))
+    return LogError("The condition of an if must be a scalar");
+  if (!unifyTypes(Then, Else, Ty))
+    return nullptr;
+  Then = convertTo(Then, Ty);
+  Else = convertTo(Else, Ty);
+  if (!Then || !Else)
+    return nullptr;
+  return this;
+}
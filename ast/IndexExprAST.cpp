@@ -0,0 +1,65 @@
+#include "ast/IndexExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
+#include "logger/logger.h"
+
+llvm::Value *IndexExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  if (isArray(Vector->getType())) {
+    llvm::Value *Addr = codegenAddress(NamedValues);
+    if (!Addr)
+      return nullptr;
+    return Builder.CreateLoad(getLLVMType(Ty), Addr, "elttmp");
+  }
+
+  llvm::Value *V = Vector->codegen(NamedValues);
+  llvm::Value *I = Index->codegen(NamedValues);
+  if (!V || !I)
+    return nullptr;
+
+  // Lanes are counted modulo the width, so that indices computed at run time
+  // never read past the vector. This folds away for constant indices
+  I = Builder.CreateAnd(I, getNumLanes(Vector->getType()) - 1, "lane");
+  return Builder.CreateExtractElement(V, I, "lanetmp");
+}
+
+// Arrays are host memory of unknown length, their indices are not checked
+llvm::Value *IndexExprAST::codegenAddress(ScopedSymbolTable &NamedValues) {
+  llvm::Value *A = Vector->codegen(NamedValues);
+  llvm::Value *I = Index->codegen(NamedValues);
+  if (!A || !I)
+    return nullptr;
+  return Builder.CreateGEP(getLLVMType(getElementType(Vector->getType())), A, I,
+                           "eltaddr");
+}
+
+void IndexExprAST::hash(ASTHasher &H) const {
+  H.add('x');
+  H.add(Vector);
+  H.add(Index);
+}
+
+ExprAST *IndexExprAST::simplify() {
+  Vector = Vector->simplify();
+  Index = Index->simplify();
+  return this;
+}
+
+ExprAST *IndexExprAST::typeCheck(TypeScope &Scope) {
+  Vector = Vector->typeCheck(Scope);
+  Index = Index->typeCheck(Scope);
+  if (!Vector || !Index)
+    return nullptr;
+
+  ValueType VectorTy = Vector->getType();
+  if (!isVector(VectorTy) && !isArray(VectorTy))
+    return LogError("Only vectors and arrays can be indexed");
+  Index = convertTo(Index, type_i64);
+  if (!Index)
+    return nullptr;
+
+  Ty = isArray(VectorTy) ? getElementType(VectorTy) : type_f64;
+  if (isArray(VectorTy))
+    Scope.addMemoryEffect(memory_read);
+  return this;
+}
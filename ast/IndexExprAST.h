@@ -0,0 +1,22 @@
+#ifndef __INDEX_EXPR_AST_H__
+#define __INDEX_EXPR_AST_H__
+
+#include "ast/ExprAST.h"
+#include "kaleidoscope/kaleidoscope.h"
+
+// Expression class for lane access like "v[2]", or element access when
+// indexing an array, which can also be assigned to like "xs[i] = 1"
+class IndexExprAST : public ExprAST {
+  ExprAST *Vector, *Index;
+
+public:
+  IndexExprAST(ExprAST *Vector, ExprAST *Index) : Vector(Vector), Index(Index) {}
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  bool isAssignable() const override { return isArray(Vector->getType()); }
+  llvm::Value *codegenAddress(ScopedSymbolTable &NamedValues) override;
+};
+
+#endif
@@ -1,6 +1,52 @@
 #include "ast/NumberExprAST.h"
+#include "ast/ASTHasher.h"
+
+#include <cmath>
 
 // Generate LLVM code for numeric literals
-llvm::Value *NumberExprAST::codegen() {
-  return llvm::ConstantFP::get(TheContext, llvm::APFloat(Val));
+llvm::Value *NumberExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  return getConstant(Ty, Val);
+}
+
+void NumberExprAST::hash(ASTHasher &H) const {
+  H.add('n');
+  H.add(Val);
+  H.add((unsigned)Ty);
+}
+
+ExprAST *NumberExprAST::simplify() { return this; }
+
+// Literals are f64 until typeCheck finds out what they are used as
+ExprAST *NumberExprAST::typeCheck(TypeScope &Scope) { return this; }
+
+bool NumberExprAST::setLiteralType(ValueType To) {
+  switch (To) {
+  case type_f64:
+  case type_vec2:
+  case type_vec4:
+  case type_vec8:
+  case type_vec16:
+    break;
+  case type_f32:
+    if ((double)(float)Val != Val && !std::isnan(Val))
+      return false;
+    break;
+  case type_i64:
+    // -2^63 <= Val < 2^63 and integral
+    if (!(Val >= -9223372036854775808.0 && Val < 9223372036854775808.0) ||
+        std::trunc(Val) != Val)
+      return false;
+    break;
+  case type_bool:
+    if (Val != 0 && Val != 1)
+      return false;
+    break;
+  case type_f64_array:
+  case type_f32_array:
+  case type_i64_array:
+  case type_inferred:
+    return false;
+  }
+  Ty = To;
+  return true;
 }
@@ -10,7 +10,17 @@ class NumberExprAST : public ExprAST {
 
 public:
   NumberExprAST(double Val) : Val(Val) {}
-  llvm::Value *codegen() override;
+  // A literal of type Ty, which must hold Val exactly, as simplify makes them
+  NumberExprAST(double Val, ValueType Ty) : Val(Val) { this->Ty = Ty; }
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  bool isConstant(double &V) const override {
+    V = Val;
+    return true;
+  }
+  bool setLiteralType(ValueType To) override;
 };
 
 #endif
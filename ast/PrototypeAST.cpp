@@ -1,15 +1,47 @@
 #include "ast/PrototypeAST.h"
+#include "kaleidoscope/fastmath.h"
 #include "kaleidoscope/kaleidoscope.h"
 
 // Generates LLVM code for externals calls
 llvm::Function *PrototypeAST::codegen() {
-  std::vector<llvm::Type *> Doubles(Args.size(), llvm::Type::getDoubleTy(TheContext));
-  llvm::FunctionType *FT = llvm::FunctionType::get(llvm::Type::getDoubleTy(TheContext), Doubles, false);
-  llvm::Function *F = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, Name.c_str(), TheModule.get());
+  std::vector<llvm::Type *> Params;
+  for (ValueType Ty : ArgTypes)
+    Params.push_back(getLLVMType(Ty));
+  llvm::FunctionType *FT = llvm::FunctionType::get(getLLVMType(ReturnType), Params, false);
+  llvm::Function *F = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, Name.getName(), TheModule.get());
+
+  if (Memory == memory_none)
+    F->setDoesNotAccessMemory();
+  if (Memory == memory_read) {
+    // The only memory there is to read is that of array arguments
+    F->setOnlyReadsMemory();
+    F->setOnlyAccessesArgMemory();
+  }
+  // Only externs can unwind, and calling one makes a function memory_any
+  if (Memory != memory_any)
+    F->setDoesNotThrow();
+  if (WillReturn)
+    F->addFnAttr(llvm::Attribute::WillReturn);
+  // Without loads there is nothing that could fault when a call is hoisted
+  // out of a branch that would not have run it
+  if (WillReturn && Memory == memory_none)
+    F->addFnAttr(llvm::Attribute::Speculatable);
+  addFastMathAttributes(*F);
+
+  // Operators are small and used like builtins, so they are expanded where
+  // they are used rather than called, even at -O0 (see InitializeOptimizer)
+  if (IsOperator)
+    F->addFnAttr(llvm::Attribute::AlwaysInline);
 
   unsigned Idx = 0;
   for (auto &Arg : F->args()) {
-    Arg.setName(Args[Idx++].c_str());
+    const ArgAttributes &Attrs = ArgAttrs[Idx];
+    if (Attrs.NoAlias)
+      Arg.addAttr(llvm::Attribute::NoAlias);
+    if (Attrs.Align)
+      Arg.addAttr(llvm::Attribute::getWithAlignment(TheContext,
+                                                    llvm::Align(Attrs.Align)));
+    Arg.setName(Args[Idx++].getName());
   }
 
   return F;
@@ -3,33 +3,99 @@
 
 #include "ast/ExprAST.h"
 #include "llvm/IR/IRBuilder.h"
+#include "lexer/symbol.h"
+#include "kaleidoscope/types.h"
+
+// What the caller promises about the memory an array argument points to
+struct ArgAttributes {
+  bool NoAlias = false; // No other argument reaches the same memory.
+  unsigned Align = 0;   // The address is a multiple of Align, if not 0.
+};
+
+// What a call to a function may do to memory, from the least to the most
+enum MemoryEffects
+{
+  memory_none, // Its result depends on its arguments alone.
+  memory_read, // Reads array elements.
+  memory_any   // Writes memory, or calls something that may.
+};
 
 /// PrototypeAST - This class represents the "prototype" for a function,
-/// which captures its argument names as well as if it is an operator.
+/// which captures its argument names and types as well as if it is an
+/// operator.
 class PrototypeAST {
-  std::string Name;
-  std::vector<std::string> Args;
+  Symbol Name;
+  std::vector<Symbol> Args;
   bool IsOperator;
   unsigned Precedence;  // Precedence if a binary op.
+  std::vector<ValueType> ArgTypes;
+  ValueType ReturnType;
+  std::vector<ArgAttributes> ArgAttrs;
+  bool Sequencing = false;
+  bool Pure = false;
+  // Until FunctionAST::typeCheck has seen the body, a function may do
+  // anything, unless it is pure
+  MemoryEffects Memory = memory_any;
+  bool WillReturn = false;
 
 public:
-  PrototypeAST(const std::string &Name, std::vector<std::string> Args,
-               bool IsOperator = false, unsigned Prec = 0)
+  // Leaving ArgTypes empty makes every argument an f64, leaving ArgAttrs
+  // empty promises nothing about any of them
+  PrototypeAST(Symbol Name, std::vector<Symbol> Args,
+               bool IsOperator = false, unsigned Prec = 0,
+               std::vector<ValueType> ArgTypes = {},
+               ValueType ReturnType = type_f64,
+               std::vector<ArgAttributes> ArgAttrs = {})
   : Name(Name), Args(std::move(Args)), IsOperator(IsOperator),
-    Precedence(Prec) {}
+    Precedence(Prec), ArgTypes(std::move(ArgTypes)), ReturnType(ReturnType),
+    ArgAttrs(std::move(ArgAttrs)) {
+    if (this->ArgTypes.empty())
+      this->ArgTypes.resize(this->Args.size(), type_f64);
+    if (this->ArgAttrs.empty())
+      this->ArgAttrs.resize(this->Args.size());
+  }
 
   llvm::Function *codegen();
-  const std::string &getName() const { return Name; }
+  Symbol getName() const { return Name; }
+  const std::vector<Symbol> &getArgs() const { return Args; }
+  ValueType getArgType(unsigned I) const { return ArgTypes[I]; }
+  const ArgAttributes &getArgAttributes(unsigned I) const { return ArgAttrs[I]; }
+  ValueType getReturnType() const { return ReturnType; }
 
   bool isUnaryOp() const { return IsOperator && Args.size() == 1; }
   bool isBinaryOp() const { return IsOperator && Args.size() == 2; }
 
   char getOperatorName() const {
     assert(isUnaryOp() || isBinaryOp());
-    return Name[Name.size() - 1];
+    return Name.getName().back();
   }
 
   unsigned getBinaryPrecedence() const { return Precedence; }
+
+  // Binary operators like "def binary : 1 (x y) y" that only give back
+  // their right operand are generated in place rather than called, so that
+  // a call on their right stays in tail position. Set by
+  // FunctionAST::typeCheck
+  bool isSequencing() const { return Sequencing; }
+  void setSequencing(bool S) { Sequencing = S; }
+
+  // 'pure' promises that the function has no side effects and always
+  // returns. A pure extern may still read the arrays it is passed
+  bool isPure() const { return Pure; }
+  void setPure() {
+    Pure = true;
+    Memory = llvm::any_of(ArgTypes, isArray) ? memory_read : memory_none;
+    WillReturn = true;
+  }
+
+  // What calls may do, see FunctionAST::typeCheck. codegen turns it into
+  // the attributes that let GVN and LICM merge and hoist calls
+  MemoryEffects getMemoryEffects() const { return Memory; }
+  bool willReturn() const { return WillReturn; }
+  void setEffects(MemoryEffects M, bool Returns) {
+    Memory = M;
+    WillReturn = Returns;
+  }
 };
 
 #endif
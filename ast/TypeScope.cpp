@@ -0,0 +1,64 @@
+#include "ast/TypeScope.h"
+#include "kaleidoscope/kaleidoscope.h"
+
+#include <cassert>
+
+void TypeScope::reset(const PrototypeAST &Proto) {
+  Types.clear();
+  Bindings.clear();
+  Scopes.clear();
+  RecursiveCalls.clear();
+  Memory = memory_none;
+  WillReturn = true;
+  Function = &Proto;
+
+  for (unsigned I = 0, E = Proto.getArgs().size(); I != E; ++I)
+    bind(Proto.getArgs()[I], Proto.getArgType(I));
+}
+
+void TypeScope::popScope() {
+  assert(!Scopes.empty() && "popScope without pushScope");
+  unsigned Mark = Scopes.back();
+  Scopes.pop_back();
+
+  while (Bindings.size() > Mark) {
+    const Shadowed &B = Bindings.back();
+    if (B.Ty == type_inferred)
+      Types.erase(B.Name);
+    else
+      Types[B.Name] = B.Ty;
+    Bindings.pop_back();
+  }
+}
+
+void TypeScope::bind(Symbol Name, ValueType Ty) {
+  auto Inserted = Types.insert({Name, Ty});
+  Bindings.push_back({Name, Inserted.second ? type_inferred
+                                            : Inserted.first->second});
+  Inserted.first->second = Ty;
+}
+
+bool TypeScope::lookup(Symbol Name, ValueType &Ty) const {
+  auto It = Types.find(Name);
+  if (It == Types.end())
+    return false;
+  Ty = It->second;
+  return true;
+}
+
+void TypeScope::addCall(const PrototypeAST &Callee) {
+  if (&Callee == Function) {
+    addLoop();
+    return;
+  }
+  addMemoryEffect(Callee.getMemoryEffects());
+  if (!Callee.willReturn())
+    addLoop();
+}
+
+const PrototypeAST *TypeScope::lookupFunction(Symbol Name) const {
+  if (Function && Function->getName() == Name)
+    return Function;
+  auto It = FunctionProtos->find(Name);
+  return It == FunctionProtos->end() ? nullptr : It->second.get();
+}
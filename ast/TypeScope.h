@@ -0,0 +1,75 @@
+#ifndef __TYPE_SCOPE_H__
+#define __TYPE_SCOPE_H__
+
+#include "ast/PrototypeAST.h"
+#include "kaleidoscope/types.h"
+#include "lexer/symbol.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <algorithm>
+#include <vector>
+
+class CallExprAST;
+
+// TypeScope - What ExprAST::typeCheck knows while it walks a function: the
+// types of the variables in scope, scoped like ScopedSymbolTable, and the
+// prototypes calls may refer to.
+//
+// It is only used on the parsing thread, which is the one that declares
+// functions, so it may read FunctionProtos while workers generate code.
+class TypeScope {
+  llvm::DenseMap<Symbol, ValueType> Types;
+
+  struct Shadowed {
+    Symbol Name;
+    // type_inferred when Name was not bound before
+    ValueType Ty;
+  };
+  std::vector<Shadowed> Bindings;
+  // Bindings.size() at every open scope
+  std::vector<unsigned> Scopes;
+
+  // The function being checked, which is not declared yet when it is
+  // generated right away
+  const PrototypeAST *Function = nullptr;
+  std::vector<const CallExprAST *> RecursiveCalls;
+  MemoryEffects Memory = memory_none;
+  bool WillReturn = true;
+
+public:
+  // Starts on a new function, with its arguments bound
+  void reset(const PrototypeAST &Proto);
+
+  void pushScope() { Scopes.push_back(Bindings.size()); }
+  void popScope();
+
+  // Binds Name in the innermost scope, shadowing any outer binding
+  void bind(Symbol Name, ValueType Ty);
+
+  // Sets Ty to the type of Name, returns false if it is not bound
+  bool lookup(Symbol Name, ValueType &Ty) const;
+
+  // The prototype of the function called Name, or null
+  const PrototypeAST *lookupFunction(Symbol Name) const;
+
+  const PrototypeAST *getFunction() const { return Function; }
+
+  // The calls of the function being checked to itself, in source order, for
+  // reporting the ones that are not tail calls
+  void addRecursiveCall(const CallExprAST *Call) { RecursiveCalls.push_back(Call); }
+  const std::vector<const CallExprAST *> &getRecursiveCalls() const {
+    return RecursiveCalls;
+  }
+
+  // What the function being checked does besides computing its result, as
+  // reported by the nodes of its body: array accesses, loops (which may not
+  // end) and calls, including those of user defined operators. Recursion
+  // counts as a loop
+  void addMemoryEffect(MemoryEffects M) { Memory = std::max(Memory, M); }
+  void addLoop() { WillReturn = false; }
+  void addCall(const PrototypeAST &Callee);
+  MemoryEffects getMemoryEffects() const { return Memory; }
+  bool willReturn() const { return WillReturn; }
+};
+
+#endif
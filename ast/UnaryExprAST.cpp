@@ -1,14 +1,46 @@
 #include "ast/UnaryExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
 #include "kaleidoscope/kaleidoscope.h"
 
-llvm::Value *UnaryExprAST::codegen() {
-  llvm::Value *OperandV = Operand->codegen();
+llvm::Value *UnaryExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  llvm::Value *OperandV = Operand->codegen(NamedValues);
   if (!OperandV)
     return nullptr;
 
-  llvm::Function *F = getFunction(std::string("unary") + Opcode);
+  llvm::Function *F = getFunction(getUnaryOpSymbol(Opcode));
   if (!F)
     return LogErrorV("Unknown unary operator");
 
   return Builder.CreateCall(F, OperandV, "unop");
-}
\ No newline at end of file
+}
+
+void UnaryExprAST::hash(ASTHasher &H) const {
+  H.add('u');
+  H.add(Opcode);
+  H.add(Operand);
+  H.addCallee(getUnaryOpSymbol(Opcode));
+}
+
+ExprAST *UnaryExprAST::simplify() {
+  // Unary operators are always user defined, so only the operand is folded
+  Operand = Operand->simplify();
+  return this;
+}
+
+ExprAST *UnaryExprAST::typeCheck(TypeScope &Scope) {
+  Operand = Operand->typeCheck(Scope);
+  if (!Operand)
+    return nullptr;
+
+  const PrototypeAST *P = Scope.lookupFunction(getUnaryOpSymbol(Opcode));
+  if (!P)
+    return LogError("Unknown unary operator");
+  Scope.addCall(*P);
+  Operand = convertTo(Operand, P->getArgType(0));
+  if (!Operand)
+    return nullptr;
+  Ty = P->getReturnType();
+  return this;
+}
@@ -8,13 +8,16 @@
 /// UnaryExprAST - Expression class for a unary operator.
 class UnaryExprAST : public ExprAST {
   char Opcode;
-  std::unique_ptr<ExprAST> Operand;
+  ExprAST *Operand;
 
 public:
-  UnaryExprAST(char Opcode, std::unique_ptr<ExprAST> Operand)
-    : Opcode(Opcode), Operand(std::move(Operand)) {}
+  UnaryExprAST(char Opcode, ExprAST *Operand)
+    : Opcode(Opcode), Operand(Operand) {}
 
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
 };
 
 #endif
\ No newline at end of file
@@ -3,18 +3,32 @@
 
 #include "ast/ExprAST.h"
 #include "llvm/IR/IRBuilder.h"
+#include "lexer/symbol.h"
+
+// One variable of a var/in
+struct VarBinding {
+  Symbol Name;
+  // type_inferred until typeCheck if there is no annotation
+  ValueType Ty;
+  // May be null
+  ExprAST *Init;
+};
 
 /// VarExprAST - Expression class for var/in
 class VarExprAST : public ExprAST {
-  std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> VarNames;
-  std::unique_ptr<ExprAST> Body;
+  llvm::MutableArrayRef<VarBinding> VarNames;
+  ExprAST *Body;
 
 public:
-  VarExprAST(std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> VarNames,
-             std::unique_ptr<ExprAST> Body)
-    : VarNames(std::move(VarNames)), Body(std::move(Body)) {}
+  // VarNames must live in TheASTArena
+  VarExprAST(llvm::MutableArrayRef<VarBinding> VarNames, ExprAST *Body)
+    : VarNames(VarNames), Body(Body) {}
 
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  void setTailPosition() override { Body->setTailPosition(); }
 };
 
 #endif
\ No newline at end of file
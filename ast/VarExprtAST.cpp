@@ -1,24 +1,30 @@
 #include "ast/VarExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "ast/TypeScope.h"
 #include "kaleidoscope/kaleidoscope.h"
 
 /// CreateEntryBlockAlloca - Create an alloca instruction in the entry block of
 /// the function.  This is used for mutable variables etc.
 static llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction,
-                                          const std::string &VarName) {
+                                          llvm::StringRef VarName,
+                                          llvm::Type *Ty) {
   llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(),
                  TheFunction->getEntryBlock().begin());
-  return TmpB.CreateAlloca(llvm::Type::getDoubleTy(TheContext), nullptr, VarName.c_str());
+  return TmpB.CreateAlloca(Ty, nullptr, VarName);
 }
 
-llvm::Value *VarExprAST::codegen() {
-  std::vector<llvm::AllocaInst *> OldBindings;
-
+llvm::Value *VarExprAST::codegen(ScopedSymbolTable &NamedValues) {
   llvm::Function *TheFunction = Builder.GetInsertBlock()->getParent();
 
+  // All variables live in one scope, popping it restores what they shadow.
+  NamedValues.pushScope();
+
   // Register all variables and emit their initializer.
   for (unsigned i = 0, e = VarNames.size(); i != e; ++i) {
-    const std::string &VarName = VarNames[i].first;
-    ExprAST *Init = VarNames[i].second.get();
+    Symbol VarName = VarNames[i].Name;
+    ValueType VarType = VarNames[i].Ty;
+    ExprAST *Init = VarNames[i].Init;
 
     // Emit the initializer before adding the variable to scope, this prevents
     // the initializer from referencing the variable itself, and permits stuff
@@ -27,33 +33,75 @@ llvm::Value *VarExprAST::codegen() {
     //    var a = a in ...   # refers to outer 'a'.
     llvm::Value *InitVal;
     if (Init) {
-      InitVal = Init->codegen();
+      InitVal = Init->codegen(NamedValues);
       if (!InitVal)
         return nullptr;
-    } else { // If not specified, use 0.0.
-      InitVal = llvm::ConstantFP::get(TheContext, llvm::APFloat(0.0));
+    } else { // If not specified, use 0.
+      InitVal = getConstant(VarType, 0.0);
     }
 
-    llvm::AllocaInst *Alloca = CreateEntryBlockAlloca(TheFunction, VarName);
+    llvm::AllocaInst *Alloca = CreateEntryBlockAlloca(
+        TheFunction, VarName.getName(), getLLVMType(VarType));
     Builder.CreateStore(InitVal, Alloca);
 
-    // Remember the old variable binding so that we can restore the binding when
-    // we unrecurse.
-    OldBindings.push_back(NamedValues[VarName]);
-
     // Remember this binding.
-    NamedValues[VarName] = Alloca;
+    NamedValues.bind(VarName, Alloca);
   }
 
   // Codegen the body, now that all vars are in scope.
-  llvm::Value *BodyVal = Body->codegen();
+  llvm::Value *BodyVal = Body->codegen(NamedValues);
   if (!BodyVal)
     return nullptr;
 
   // Pop all our variables from scope.
-  for (unsigned i = 0, e = VarNames.size(); i != e; ++i)
-    NamedValues[VarNames[i].first] = OldBindings[i];
+  NamedValues.popScope();
 
   // Return the body computation.
   return BodyVal;
-}
\ No newline at end of file
+}
+
+void VarExprAST::hash(ASTHasher &H) const {
+  H.add('V');
+  H.add((unsigned)VarNames.size());
+  for (const VarBinding &Var : VarNames) {
+    H.add(Var.Name);
+    H.add((unsigned)Var.Ty);
+    H.add(Var.Init);
+  }
+  H.add(Body);
+}
+
+ExprAST *VarExprAST::simplify() {
+  for (VarBinding &Var : VarNames)
+    if (Var.Init)
+      Var.Init = Var.Init->simplify();
+  Body = Body->simplify();
+  return this;
+}
+
+ExprAST *VarExprAST::typeCheck(TypeScope &Scope) {
+  // Same scoping as codegen, an initializer sees the variables before it
+  Scope.pushScope();
+  for (VarBinding &Var : VarNames) {
+    if (Var.Init) {
+      Var.Init = Var.Init->typeCheck(Scope);
+      if (!Var.Init)
+        return nullptr;
+      if (Var.Ty == type_inferred)
+        Var.Ty = Var.Init->getType();
+      Var.Init = convertTo(Var.Init, Var.Ty);
+      if (!Var.Init)
+        return nullptr;
+    } else if (Var.Ty == type_inferred) {
+      Var.Ty = type_f64;
+    }
+    Scope.bind(Var.Name, Var.Ty);
+  }
+
+  Body = Body->typeCheck(Scope);
+  Scope.popScope();
+  if (!Body)
+    return nullptr;
+  Ty = Body->getType();
+  return this;
+}
@@ -1,13 +1,35 @@
 #include "ast/VariableExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/TypeScope.h"
 #include "kaleidoscope/kaleidoscope.h"
 
 // We assume that the variable has already been emitted somewhere
-llvm::Value *VariableExprAST::codegen() {
+llvm::Value *VariableExprAST::codegen(ScopedSymbolTable &NamedValues) {
   // Look this variable up in the function.
-  llvm::AllocaInst *A = NamedValues[Name];
+  llvm::AllocaInst *A = NamedValues.lookup(Name);
   if (!A)
     return LogErrorV("Unknown variable name");
 
   // Load the value.
-  return Builder.CreateLoad(A->getAllocatedType(), A, Name.c_str());
-}
\ No newline at end of file
+  return Builder.CreateLoad(A->getAllocatedType(), A, Name.getName());
+}
+
+llvm::Value *VariableExprAST::codegenAddress(ScopedSymbolTable &NamedValues) {
+  llvm::AllocaInst *A = NamedValues.lookup(Name);
+  if (!A)
+    return LogErrorV("Unknown variable name");
+  return A;
+}
+
+void VariableExprAST::hash(ASTHasher &H) const {
+  H.add('v');
+  H.add(Name);
+}
+
+ExprAST *VariableExprAST::simplify() { return this; }
+
+ExprAST *VariableExprAST::typeCheck(TypeScope &Scope) {
+  if (!Scope.lookup(Name, Ty))
+    return LogError("Unknown variable name");
+  return this;
+}
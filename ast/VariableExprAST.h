@@ -3,15 +3,25 @@
 
 #include "ast/ExprAST.h"
 #include "logger/logger.h"
+#include "lexer/symbol.h"
 
 // Expression class for referencing a variable, like "a"
 class VariableExprAST : public ExprAST {
-  std::string Name;
+  Symbol Name;
 
 public:
-  VariableExprAST(const std::string &Name) : Name(Name) {}
-  llvm::Value *codegen() override;
-  const std::string &getName() const { return Name; }
+  VariableExprAST(Symbol Name) : Name(Name) {}
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+  bool isVariable(Symbol &Var) const override {
+    Var = Name;
+    return true;
+  }
+  bool isAssignable() const override { return true; }
+  llvm::Value *codegenAddress(ScopedSymbolTable &NamedValues) override;
+  Symbol getName() const { return Name; }
 };
 
 #endif
@@ -0,0 +1,44 @@
+#include "ast/VectorExprAST.h"
+#include "ast/ASTHasher.h"
+#include "ast/CastExprAST.h"
+#include "logger/logger.h"
+
+// Literals with constant elements fold into one vector constant
+llvm::Value *VectorExprAST::codegen(ScopedSymbolTable &NamedValues) {
+  llvm::Value *V = llvm::PoisonValue::get(getLLVMType(Ty));
+  for (unsigned i = 0, e = Elements.size(); i != e; i++) {
+    llvm::Value *Element = Elements[i]->codegen(NamedValues);
+    if (!Element)
+      return nullptr;
+    V = Builder.CreateInsertElement(V, Element, (uint64_t)i, "vectmp");
+  }
+  return V;
+}
+
+void VectorExprAST::hash(ASTHasher &H) const {
+  H.add('[');
+  H.add((unsigned)Elements.size());
+  for (const ExprAST *Element : Elements)
+    H.add(Element);
+}
+
+ExprAST *VectorExprAST::simplify() {
+  for (ExprAST *&Element : Elements)
+    Element = Element->simplify();
+  return this;
+}
+
+ExprAST *VectorExprAST::typeCheck(TypeScope &Scope) {
+  if (!getVectorType(Elements.size(), Ty))
+    return LogError("Vectors must have 2, 4, 8 or 16 elements");
+
+  for (ExprAST *&Element : Elements) {
+    Element = Element->typeCheck(Scope);
+    if (!Element)
+      return nullptr;
+    Element = convertTo(Element, type_f64);
+    if (!Element)
+      return nullptr;
+  }
+  return this;
+}
@@ -0,0 +1,20 @@
+#ifndef __VECTOR_EXPR_AST_H__
+#define __VECTOR_EXPR_AST_H__
+
+#include "ast/ExprAST.h"
+#include "kaleidoscope/kaleidoscope.h"
+
+// Expression class for vector literals like "[1, 2, x, y]"
+class VectorExprAST : public ExprAST {
+  llvm::MutableArrayRef<ExprAST *> Elements;
+
+public:
+  // Elements must live in TheASTArena
+  VectorExprAST(llvm::MutableArrayRef<ExprAST *> Elements) : Elements(Elements) {}
+  llvm::Value *codegen(ScopedSymbolTable &NamedValues) override;
+  void hash(ASTHasher &H) const override;
+  ExprAST *simplify() override;
+  ExprAST *typeCheck(TypeScope &Scope) override;
+};
+
+#endif
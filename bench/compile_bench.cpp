@@ -0,0 +1,132 @@
+// Measures end to end compile time of ./main over a sweep of synthetic
+// workload sizes (see bench/workload.h). Every stage is a separate run of
+// the compiler, so the numbers include process start up and the peak RSS
+// is that of the whole run.
+//
+//   make bench-compile
+//   ./bench/compile_bench [path to main] [largest number of functions]
+
+// bench headers
+#include "bench/workload.h"
+
+// LLVM headers
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+// stdlib headers
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// POSIX headers
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+// One configuration of the compiler, from front end only to native code
+struct Stage {
+  const char *Name;
+  std::vector<const char *> Flags;
+};
+
+struct RunResult {
+  bool Ok;
+  double Seconds;
+  double PeakMB;
+};
+
+// Runs Main on Input with the stage's flags, output goes to /dev/null
+static RunResult runStage(const char *Main, const Stage &S, const char *Input) {
+  std::vector<const char *> Argv;
+  Argv.push_back(Main);
+  Argv.insert(Argv.end(), S.Flags.begin(), S.Flags.end());
+  Argv.push_back("-o");
+  Argv.push_back("/dev/null");
+  Argv.push_back(Input);
+  Argv.push_back(nullptr);
+
+  // Keep stderr quiet, the compiler echoes every definition there
+  posix_spawn_file_actions_t Actions;
+  posix_spawn_file_actions_init(&Actions);
+  posix_spawn_file_actions_addopen(&Actions, 2, "/dev/null", O_WRONLY, 0);
+
+  auto Start = std::chrono::steady_clock::now();
+  pid_t Pid;
+  int Err = posix_spawn(&Pid, Main, &Actions, nullptr,
+                        const_cast<char *const *>(Argv.data()), environ);
+  posix_spawn_file_actions_destroy(&Actions);
+  if (Err)
+    return {false, 0, 0};
+
+  int Status;
+  struct rusage Usage;
+  if (wait4(Pid, &Status, 0, &Usage) != Pid)
+    return {false, 0, 0};
+  auto Stop = std::chrono::steady_clock::now();
+
+#ifdef __APPLE__
+  double PeakMB = Usage.ru_maxrss / double(1 << 20); // bytes
+#else
+  double PeakMB = Usage.ru_maxrss / double(1 << 10); // kilobytes
+#endif
+  bool Ok = WIFEXITED(Status) && WEXITSTATUS(Status) == 0;
+  return {Ok, std::chrono::duration<double>(Stop - Start).count(), PeakMB};
+}
+
+int main(int argc, char **argv) {
+  const char *Main = argc > 1 ? argv[1] : "./main";
+  unsigned MaxFunctions = argc > 2 ? strtoul(argv[2], nullptr, 10) : 10000;
+  if (!MaxFunctions)
+    MaxFunctions = 10000;
+
+  const Stage Stages[] = {{"ir -O0", {"--emit=ll", "-O0"}},
+                          {"ir -O2", {"--emit=ll", "-O2"}},
+                          {"obj -O0", {"--emit=obj", "-O0"}},
+                          {"obj -O2", {"--emit=obj", "-O2"}}};
+
+  llvm::SmallString<128> Input;
+  int FD;
+  if (llvm::sys::fs::createTemporaryFile("workload", "ks", FD, Input)) {
+    fprintf(stderr, "compile_bench: cannot create a temporary file\n");
+    return 1;
+  }
+  llvm::sys::fs::closeFile(FD);
+
+  printf("%-10s %-8s %8s %10s %12s %12s %10s\n", "functions", "stage",
+         "lines", "seconds", "lines/s", "functions/s", "peak MB");
+  int Failed = 0;
+  for (unsigned N = 10; N <= MaxFunctions; N *= 10) {
+    WorkloadShape Shape;
+    Shape.Functions = N;
+
+    unsigned Lines;
+    {
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(Input, EC);
+      if (EC) {
+        fprintf(stderr, "compile_bench: %s\n", EC.message().c_str());
+        return 1;
+      }
+      Lines = generateWorkload(Shape, OS);
+    }
+
+    for (const Stage &S : Stages) {
+      RunResult R = runStage(Main, S, Input.c_str());
+      if (!R.Ok) {
+        printf("%-10u %-8s failed\n", N, S.Name);
+        Failed = 1;
+        continue;
+      }
+      printf("%-10u %-8s %8u %10.3f %12.0f %12.0f %10.1f\n", N, S.Name, Lines,
+             R.Seconds, Lines / R.Seconds, N / R.Seconds, R.PeakMB);
+    }
+  }
+
+  llvm::sys::fs::remove(Input);
+  return Failed;
+}
@@ -0,0 +1,41 @@
+// Writes a synthetic Kaleidoscope program of a tunable shape, e.g.
+//
+//   ./bench/gen_workload --functions=5000 --depth=6 --nesting=3 > big.ks
+//   ./main -O2 big.ks > big.ll
+
+// bench headers
+#include "bench/workload.h"
+
+// LLVM headers
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+static cl::opt<unsigned> Functions("functions", cl::init(100),
+    cl::desc("Number of function definitions"));
+static cl::opt<unsigned> Depth("depth", cl::init(4),
+    cl::desc("Expression depth of each function body"));
+static cl::opt<unsigned> Nesting("nesting", cl::init(1),
+    cl::desc("Number of var/for levels around each body"));
+static cl::opt<double> OperatorDensity("op-density", cl::init(0.2),
+    cl::desc("Share of operators that are user defined, 0 to 1"));
+static cl::opt<unsigned> FanOut("fanout", cl::init(2),
+    cl::desc("Calls from each function to earlier ones"));
+static cl::opt<unsigned> Seed("seed", cl::init(1),
+    cl::desc("Random seed"));
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Kaleidoscope workload generator\n");
+
+  WorkloadShape Shape;
+  Shape.Functions = Functions;
+  Shape.Depth = Depth;
+  Shape.Nesting = Nesting;
+  Shape.OperatorDensity = OperatorDensity;
+  Shape.FanOut = FanOut;
+  Shape.Seed = Seed;
+
+  generateWorkload(Shape, outs());
+  return 0;
+}
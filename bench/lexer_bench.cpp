@@ -0,0 +1,130 @@
+// Measures lexer throughput in MB/s over synthetic Kaleidoscope sources.
+// Each workload stresses a different part of gettok: long identifiers,
+// keywords, numbers, whitespace/comments and a realistic mix.
+//
+//   make bench-lexer
+//   ./bench/lexer_bench [megabytes per workload]
+
+// lexer headers
+#include "lexer/lexer.h"
+#include "lexer/scanner.h"
+#include "lexer/token.h"
+
+// LLVM headers
+#include "llvm/Support/MemoryBuffer.h"
+
+// stdlib headers
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+// Appends one "line" of a workload to Out, Rand keeps runs reproducible
+typedef void (*LineGenerator)(std::string &Out, std::mt19937 &Rand);
+
+static void appendIdentifier(std::string &Out, std::mt19937 &Rand, unsigned Len) {
+  static const char Chars[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  Out += Chars[Rand() % 52];
+  for (unsigned i = 1; i < Len; ++i)
+    Out += Chars[Rand() % 62];
+}
+
+static void identifierLine(std::string &Out, std::mt19937 &Rand) {
+  for (unsigned i = 0; i != 8; ++i) {
+    appendIdentifier(Out, Rand, 4 + Rand() % 28);
+    Out += ' ';
+  }
+  Out += '\n';
+}
+
+static void keywordLine(std::string &Out, std::mt19937 &Rand) {
+  static const char *Words[] = {"def", "extern", "if", "then", "else", "for",
+                                "in", "binary", "unary", "var", "x", "fib"};
+  for (unsigned i = 0; i != 12; ++i) {
+    Out += Words[Rand() % 12];
+    Out += ' ';
+  }
+  Out += '\n';
+}
+
+static void numberLine(std::string &Out, std::mt19937 &Rand) {
+  for (unsigned i = 0; i != 8; ++i) {
+    Out += std::to_string(Rand() % 100000);
+    Out += '.';
+    Out += std::to_string(Rand() % 1000);
+    Out += " + ";
+  }
+  Out += "0\n";
+}
+
+static void spaceLine(std::string &Out, std::mt19937 &Rand) {
+  Out.append(Rand() % 64, ' ');
+  Out += "x";
+  Out.append(Rand() % 8, '\t');
+  Out += "# a comment that runs on for a while before the line ends\n";
+}
+
+static void mixedLine(std::string &Out, std::mt19937 &Rand) {
+  unsigned N = Rand() % 1000;
+  Out += "def f" + std::to_string(N) + "(x y)\n";
+  Out += "  var a = 1, b = 2 in\n";
+  Out += "    (for i = 1, i < x in a = a + b * 3.5) : # loop\n";
+  Out += "    if a < y then fib(x-1) + fib(x-2) else a;\n";
+}
+
+static std::string generate(LineGenerator Line, size_t Bytes) {
+  std::mt19937 Rand(42);
+  std::string Out;
+  Out.reserve(Bytes + 256);
+  while (Out.size() < Bytes)
+    Line(Out, Rand);
+  return Out;
+}
+
+// Lexes Source to the end, best of a few runs, and returns seconds taken
+static double timeLexer(const std::string &Source, unsigned &NumTokens) {
+  double Best = 1e30;
+  for (unsigned Run = 0; Run != 5; ++Run) {
+    InitializeLexer(llvm::MemoryBuffer::getMemBuffer(Source, "bench", false));
+
+    auto Start = std::chrono::steady_clock::now();
+    unsigned Count = 0;
+    while (gettok() != tok_eof)
+      ++Count;
+    auto Stop = std::chrono::steady_clock::now();
+
+    NumTokens = Count;
+    double Seconds = std::chrono::duration<double>(Stop - Start).count();
+    if (Seconds < Best)
+      Best = Seconds;
+  }
+  return Best;
+}
+
+int main(int argc, char **argv) {
+  size_t Megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 16;
+  if (!Megabytes)
+    Megabytes = 16;
+
+  struct {
+    const char *Name;
+    LineGenerator Line;
+  } Workloads[] = {{"identifiers", identifierLine},
+                   {"keywords", keywordLine},
+                   {"numbers", numberLine},
+                   {"whitespace", spaceLine},
+                   {"mixed", mixedLine}};
+
+  printf("scanner: %s, %zu MB per workload\n", getScannerName(), Megabytes);
+  printf("%-12s %12s %12s %12s\n", "workload", "tokens", "MB/s", "Mtok/s");
+  for (auto &W : Workloads) {
+    std::string Source = generate(W.Line, Megabytes << 20);
+    unsigned NumTokens = 0;
+    double Seconds = timeLexer(Source, NumTokens);
+    printf("%-12s %12u %12.1f %12.1f\n", W.Name, NumTokens,
+           Source.size() / Seconds / (1 << 20), NumTokens / Seconds / 1e6);
+  }
+  return 0;
+}
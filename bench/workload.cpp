@@ -0,0 +1,169 @@
+#include "bench/workload.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The user defined operators every workload starts with, the binary ones
+// are used as often as OperatorDensity asks for
+const char *const OperatorDefs[] = {
+    "def binary : 1 (x y) y;",
+    "def binary | 5 (a b) if a then 1 else if b then 1 else 0;",
+    "def binary & 6 (a b) if a then (if b then 1 else 0) else 0;",
+    "def binary > 10 (a b) b < a;",
+    "def binary ^ 30 (a b) a * a + b;",
+    "def unary ! (v) if v then 0 else 1;",
+    "def unary - (v) 0 - v;",
+};
+const char UserBinaryOps[] = {'|', '&', '>', '^'};
+const char BuiltinBinaryOps[] = {'+', '-', '*', '<'};
+const char UserUnaryOps[] = {'!', '-'};
+
+class WorkloadGenerator {
+  const WorkloadShape &Shape;
+  std::mt19937 Rand;
+  llvm::raw_ostream &OS;
+  unsigned Lines = 0;
+
+  // Arity of every function emitted so far
+  std::vector<unsigned> Arities;
+  // Names that are in scope in the body being generated
+  std::vector<std::string> Names;
+
+  unsigned pick(unsigned N) { return Rand() % N; }
+  bool chance(double P) { return std::uniform_real_distribution<double>(0, 1)(Rand) < P; }
+
+  void newline() {
+    OS << '\n';
+    ++Lines;
+  }
+
+  void genLeaf() {
+    if (!Names.empty() && pick(3) != 0)
+      OS << Names[pick(Names.size())];
+    else
+      OS << pick(100) << '.' << pick(10);
+  }
+
+  void genCall(unsigned Callee, unsigned Depth) {
+    OS << 'f' << Callee << '(';
+    for (unsigned i = 0; i != Arities[Callee]; ++i) {
+      if (i)
+        OS << ", ";
+      genExpr(Depth);
+    }
+    OS << ')';
+  }
+
+  void genExpr(unsigned Depth) {
+    if (Depth == 0)
+      return genLeaf();
+
+    switch (pick(8)) {
+    case 0:
+      OS << "(if ";
+      genExpr(Depth - 1);
+      OS << " then ";
+      genExpr(Depth - 1);
+      OS << " else ";
+      genExpr(Depth - 1);
+      OS << ')';
+      return;
+    case 1:
+      if (chance(Shape.OperatorDensity)) {
+        OS << UserUnaryOps[pick(sizeof(UserUnaryOps))] << '(';
+        genExpr(Depth - 1);
+        OS << ')';
+        return;
+      }
+      break;
+    default:
+      break;
+    }
+
+    char Op = chance(Shape.OperatorDensity)
+                  ? UserBinaryOps[pick(sizeof(UserBinaryOps))]
+                  : BuiltinBinaryOps[pick(sizeof(BuiltinBinaryOps))];
+    OS << '(';
+    genExpr(Depth - 1);
+    OS << ' ' << Op << ' ';
+    genExpr(Depth - 1);
+    OS << ')';
+  }
+
+  // Wraps the body in Level more 'var' or 'for' scopes, alternating
+  void genNested(unsigned Level) {
+    if (Level == 0) {
+      genExpr(Shape.Depth);
+      return;
+    }
+
+    std::string Name = (Level % 2 ? "v" : "i") + std::to_string(Level);
+    newline();
+    OS.indent(2 * (Shape.Nesting - Level + 1));
+    if (Level % 2) {
+      OS << "var " << Name << " = ";
+      genExpr(1);
+      OS << " in (";
+      Names.push_back(Name);
+      genNested(Level - 1);
+      OS << ')';
+    } else {
+      OS << "(for " << Name << " = 1, " << Name << " < " << (2 + pick(8))
+         << " in ";
+      Names.push_back(Name);
+      genNested(Level - 1);
+      Names.pop_back();
+      OS << ") : ";
+      genExpr(1);
+      return;
+    }
+    Names.pop_back();
+  }
+
+  void genFunction(unsigned Index) {
+    unsigned Arity = 1 + pick(3);
+    OS << "def f" << Index << '(';
+    Names.clear();
+    for (unsigned i = 0; i != Arity; ++i) {
+      Names.push_back("a" + std::to_string(i));
+      OS << (i ? " " : "") << Names.back();
+    }
+    OS << ')';
+
+    genNested(Shape.Nesting);
+
+    // Fan out to functions defined earlier, callees must already exist
+    for (unsigned i = 0; i != Shape.FanOut && Index != 0; ++i) {
+      newline();
+      OS << "  + ";
+      genCall(pick(Index), 1);
+    }
+    OS << ';';
+    newline();
+
+    Arities.push_back(Arity);
+  }
+
+public:
+  WorkloadGenerator(const WorkloadShape &Shape, llvm::raw_ostream &OS)
+      : Shape(Shape), Rand(Shape.Seed), OS(OS) {}
+
+  unsigned run() {
+    for (const char *Def : OperatorDefs) {
+      OS << Def;
+      newline();
+    }
+    for (unsigned i = 0; i != Shape.Functions; ++i)
+      genFunction(i);
+    return Lines;
+  }
+};
+
+} // namespace
+
+unsigned generateWorkload(const WorkloadShape &Shape, llvm::raw_ostream &OS) {
+  return WorkloadGenerator(Shape, OS).run();
+}
@@ -0,0 +1,26 @@
+#ifndef __WORKLOAD_H__
+#define __WORKLOAD_H__
+
+#include "llvm/Support/raw_ostream.h"
+
+// The knobs of a synthetic Kaleidoscope program, see generateWorkload
+struct WorkloadShape {
+  // Number of 'def's, not counting the operator definitions
+  unsigned Functions = 100;
+  // Depth of the expression tree in each function body
+  unsigned Depth = 4;
+  // Number of 'var'/'for' levels wrapped around each body
+  unsigned Nesting = 1;
+  // Share of binary operators that call a user defined operator, 0 to 1
+  double OperatorDensity = 0.2;
+  // Calls each function makes to functions defined before it
+  unsigned FanOut = 2;
+  // Same seed and shape give the same program
+  unsigned Seed = 1;
+};
+
+// Writes a valid Kaleidoscope program of the given shape to OS and returns
+// the number of lines written
+unsigned generateWorkload(const WorkloadShape &Shape, llvm::raw_ostream &OS);
+
+#endif
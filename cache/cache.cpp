@@ -0,0 +1,233 @@
+#include "cache/cache.h"
+#include "ast/ASTHasher.h"
+#include "emitter/emitter.h"
+#include "kaleidoscope/fastmath.h"
+#include "kaleidoscope/kaleidoscope.h"
+#include "logger/logger.h"
+#include "optimizer/optimizer.h"
+#include "parser/parser.h"
+#include "stats/stats.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+// Bump whenever codegen changes in a way the key does not capture, so that
+// stale entries are never picked up
+static const unsigned CacheFormatVersion = 4;
+
+// Per thread like the other compiler settings, empty while the cache is off
+static thread_local std::string CacheDir;
+
+bool InitializeCache(const std::string &Dir) {
+  if (Dir.empty()) {
+    CacheDir.clear();
+    return true;
+  }
+  if (std::error_code EC = llvm::sys::fs::create_directories(Dir)) {
+    llvm::errs() << "Could not create cache directory " << Dir << ": "
+                 << EC.message() << "\n";
+    return false;
+  }
+  CacheDir = Dir;
+  return true;
+}
+
+bool isCacheEnabled() { return !CacheDir.empty(); }
+
+const std::string &getCacheDirectory() { return CacheDir; }
+
+std::string getCacheKey(const FunctionAST &F) {
+  ASTHasher H;
+
+  H.add(CacheFormatVersion);
+  H.add(llvm::StringRef(LLVM_VERSION_STRING));
+  H.add(llvm::StringRef(TheTargetMachine->getTargetTriple().str()));
+  H.add(TheTargetMachine->getTargetCPU());
+  H.add(TheTargetMachine->getTargetFeatureString());
+  H.add(OptLevel);
+  H.add((unsigned)TheFastMathFlags.allowReassoc());
+  H.add((unsigned)TheFastMathFlags.noNaNs());
+  H.add((unsigned)TheFastMathFlags.noInfs());
+  H.add((unsigned)TheFastMathFlags.noSignedZeros());
+  H.add((unsigned)TheFastMathFlags.allowReciprocal());
+  H.add((unsigned)TheFastMathFlags.allowContract());
+  H.add((unsigned)TheFastMathFlags.approxFunc());
+  H.add((unsigned)FlushDenormals);
+
+  F.hash(H);
+
+  // A call is generated from the callee's prototype, a recursive call from
+  // the function's own one, which is already part of the hash
+  for (Symbol Callee : H.getCallees()) {
+    if (Callee == F.getName())
+      continue;
+    auto It = FunctionProtos->find(Callee);
+    if (It == FunctionProtos->end()) {
+      H.add('0');
+      H.add(Callee);
+    } else {
+      H.add(*It->second);
+    }
+  }
+
+  H.add((unsigned)BinopPrecedence.size());
+  for (const auto &Prec : BinopPrecedence) {
+    H.add(Prec.first);
+    H.add((unsigned)Prec.second);
+  }
+
+  return H.finish();
+}
+
+static std::string getEntryPath(const std::string &Key) {
+  llvm::SmallString<128> Path(CacheDir);
+  llvm::sys::path::append(Path, Key + ".bc");
+  return std::string(Path.str());
+}
+
+// Reads the entry at Path into TheContext, null if there is none or it
+// cannot be read (e.g. left behind by another LLVM version)
+static std::unique_ptr<llvm::Module> loadEntry(const std::string &Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return nullptr;
+
+  auto M = llvm::parseBitcodeFile((*Buffer)->getMemBufferRef(), TheContext);
+  if (!M) {
+    llvm::consumeError(M.takeError());
+    return nullptr;
+  }
+  return std::move(*M);
+}
+
+// Writes M to Path through a temporary file, so that other processes and
+// threads never see half an entry
+static void storeEntry(const std::string &Path, const llvm::Module &M) {
+  int FD;
+  llvm::SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%.tmp", FD, TempPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    llvm::WriteBitcodeToFile(M, OS, /*ShouldPreserveUseListOrder=*/true);
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
+
+// Moves the function Name from Src into Dest, where it ends up just as if
+// it had been generated there. Src holds nothing but that function and
+// declarations of the functions it calls, so this is much cheaper than
+// llvm::Linker, which walks the whole of Dest every time it is set up.
+// Returns null, with both modules left as they were, if Dest already
+// defines Name or declares it or a callee differently
+static llvm::Function *moveFunction(llvm::Module &Src, llvm::Module &Dest,
+                                    llvm::StringRef Name) {
+  llvm::Function *F = Src.getFunction(Name);
+  llvm::Function *Existing = Dest.getFunction(Name);
+  if (!F || F->isDeclaration())
+    return nullptr;
+  if (Existing && (!Existing->isDeclaration() ||
+                   Existing->getFunctionType() != F->getFunctionType()))
+    return nullptr;
+  for (llvm::Function &Callee : Src) {
+    llvm::Function *DestCallee = Dest.getFunction(Callee.getName());
+    if (&Callee != F && DestCallee &&
+        DestCallee->getFunctionType() != Callee.getFunctionType())
+      return nullptr;
+  }
+
+  // Take the place of a declaration of the function, if there is one
+  F->removeFromParent();
+  if (Existing) {
+    Existing->setName("");
+    Dest.getFunctionList().insert(Existing->getIterator(), F);
+    Existing->replaceAllUsesWith(F);
+    Existing->eraseFromParent();
+  } else {
+    Dest.getFunctionList().push_back(F);
+  }
+
+  // Point the calls at declarations in Dest, adding the missing ones
+  for (llvm::Function &Callee : Src) {
+    llvm::Function *DestCallee = Dest.getFunction(Callee.getName());
+    if (!DestCallee) {
+      DestCallee = llvm::Function::Create(Callee.getFunctionType(),
+                                          Callee.getLinkage(),
+                                          Callee.getName(), Dest);
+      DestCallee->copyAttributesFrom(&Callee);
+      for (unsigned i = 0, e = Callee.arg_size(); i != e; ++i)
+        DestCallee->getArg(i)->setName(Callee.getArg(i)->getName());
+    }
+    Callee.replaceAllUsesWith(DestCallee);
+  }
+
+  return F;
+}
+
+llvm::Function *CodegenCached(FunctionAST &F, const std::string &Key,
+                              ScopedSymbolTable &NamedValues) {
+  std::string Path = getEntryPath(Key);
+  llvm::StringRef Name = F.getName().getName();
+
+  std::unique_ptr<llvm::Module> Cached;
+  {
+    PhaseTimer Timer(phase_cache);
+    Cached = loadEntry(Path);
+  }
+  if (Cached) {
+    F.declare();
+
+    PhaseTimer Timer(phase_link);
+    if (llvm::Function *FnIR = moveFunction(*Cached, *TheModule, Name)) {
+      ++NumCacheHits;
+      return FnIR;
+    }
+    // An entry that does not fit is generated again below, which reports
+    // what is wrong with it
+  }
+
+  // Generate the function into a module of its own, which is what gets
+  // stored, and move it into TheModule from there
+  ++NumCacheMisses;
+  std::unique_ptr<llvm::Module> Outer = std::move(TheModule);
+  InitializeModule();
+  SetModuleTarget(*TheModule);
+
+  llvm::Function *FnIR = F.codegen(NamedValues);
+  if (FnIR) {
+    {
+      PhaseTimer Timer(phase_cache);
+      storeEntry(Path, *TheModule);
+    }
+
+    PhaseTimer Timer(phase_link);
+    FnIR = moveFunction(*TheModule, *Outer, Name);
+    if (!FnIR) {
+      // Functions generated on worker threads report the same
+      llvm::Function *Existing = Outer->getFunction(Name);
+      std::string Msg = (Existing && !Existing->isDeclaration()
+                             ? "Redefinition of "
+                             : "Conflicting declarations of ") +
+                        Name.str();
+      LogError(Msg.c_str());
+    }
+  }
+
+  TheModule = std::move(Outer);
+  return FnIR;
+}
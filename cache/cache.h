@@ -0,0 +1,40 @@
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+#include "ast/FunctionAST.h"
+#include "kaleidoscope/symboltable.h"
+
+#include <string>
+
+// The function cache keeps the IR of every generated function on disk,
+// after the per-function passes, as one bitcode file per function named by
+// the function's cache key. A function whose key is found there is linked
+// in from the file instead of being generated and optimized again. The
+// module pipeline still runs on the whole module, since it works across
+// functions.
+
+// Points the calling thread's cache at Dir, creating it if needed. Until
+// this has been called successfully the cache is off, and an empty Dir
+// turns it off again. Returns false and logs the reason if Dir cannot be
+// used
+bool InitializeCache(const std::string &Dir);
+
+bool isCacheEnabled();
+
+// The directory of the calling thread's cache, empty while it is off
+const std::string &getCacheDirectory();
+
+// The cache key of F: a hash of its structure, of the prototypes of the
+// functions it calls as they are declared right now, of the operator
+// precedences and of the compiler settings that change the generated code
+// (LLVM version, target and optimization level). Only the parsing thread
+// may compute keys
+std::string getCacheKey(const FunctionAST &F);
+
+// Does what F.codegen does, going through the cache: on a hit the stored
+// function is linked into TheModule, on a miss F is generated and stored.
+// Safe to call from several threads at once, each with its own TheModule
+llvm::Function *CodegenCached(FunctionAST &F, const std::string &Key,
+                              ScopedSymbolTable &NamedValues);
+
+#endif
@@ -0,0 +1,168 @@
+// Compiles a program on a server started with main --serve, as main would
+// itself: the input file (standard input by default) and -o work the same,
+// and every other flag is passed on to the server, which takes main's
+// compile flags with their values after '=' (e.g. --emit=obj, not
+// --emit obj). --jit and --time-report are main's alone. Relative paths
+// given to --cache-dir and --profile-use are made absolute here, so that
+// the server finds what main would in the client's directory.
+//
+//   ./main --serve=/tmp/kaleidoscope.sock &
+//   cat file | ./client --socket=/tmp/kaleidoscope.sock -O2 --emit=obj -o file.o
+//
+// The socket may also be given in $KALEIDOSCOPE_SOCKET. This does not link
+// LLVM, so that it starts as fast as a process can
+
+// compile server headers
+#include "server/protocol.h"
+
+// stdlib headers
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// POSIX headers
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Reads the whole of FD into Data
+static bool readFile(int FD, std::string &Data) {
+  char Buffer[1 << 16];
+  while (true) {
+    ssize_t N = read(FD, Buffer, sizeof(Buffer));
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N < 0)
+      return false;
+    if (N == 0)
+      return true;
+    Data.append(Buffer, N);
+  }
+}
+
+// The flags whose values are files the compiler reads or creates. The file
+// --profile-generate names is written by the compiled program wherever it
+// runs, so that one goes to the server as given, as main would embed it
+static const char *const PathFlags[] = {"cache-dir=", "profile-use="};
+
+// Appends Arg and a NUL to Flags, with a relative path in its value made
+// absolute against the current directory
+static void addFlag(std::string &Flags, const char *Arg) {
+  const char *Name = Arg + strspn(Arg, "-");
+  for (const char *Flag : PathFlags) {
+    size_t Size = strlen(Flag);
+    const char *Value = Name + Size;
+    if (strncmp(Name, Flag, Size) || !*Value || *Value == '/')
+      continue;
+    char Dir[PATH_MAX];
+    if (!getcwd(Dir, sizeof(Dir)))
+      break;
+    Flags.append(Arg, Value - Arg).append(Dir).append("/").append(Value);
+    Flags.push_back('\0');
+    return;
+  }
+  Flags.append(Arg).push_back('\0');
+}
+
+static int connectTo(const char *Path) {
+  sockaddr_un Addr;
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (strlen(Path) >= sizeof(Addr.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", Path);
+    return -1;
+  }
+  strcpy(Addr.sun_path, Path);
+
+  int FD = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0 || connect(FD, (sockaddr *)&Addr, sizeof(Addr)) != 0) {
+    fprintf(stderr, "Cannot connect to %s: %s\n", Path, strerror(errno));
+    if (FD >= 0)
+      close(FD);
+    return -1;
+  }
+  return FD;
+}
+
+int main(int argc, char **argv) {
+  const char *Socket = getenv("KALEIDOSCOPE_SOCKET");
+  const char *InputFilename = "-";
+  const char *OutputFilename = "-";
+
+  // The flags for the server, each followed by a NUL
+  std::string Flags;
+  for (int I = 1; I < argc; ++I) {
+    const char *Arg = argv[I];
+    if (!strncmp(Arg, "--socket=", 9) || !strncmp(Arg, "-socket=", 8)) {
+      Socket = strchr(Arg, '=') + 1;
+    } else if (!strcmp(Arg, "-o") && I + 1 < argc) {
+      OutputFilename = argv[++I];
+    } else if (!strncmp(Arg, "-o=", 3)) {
+      OutputFilename = Arg + 3;
+    } else if (Arg[0] == '-' && Arg[1]) {
+      addFlag(Flags, Arg);
+    } else {
+      InputFilename = Arg;
+    }
+  }
+  if (!Socket || !*Socket) {
+    fprintf(stderr, "No server socket, give --socket= or set "
+                    "KALEIDOSCOPE_SOCKET\n");
+    return 1;
+  }
+
+  std::string Source;
+  int InputFD = strcmp(InputFilename, "-") ? open(InputFilename, O_RDONLY) : 0;
+  if (InputFD < 0 || !readFile(InputFD, Source)) {
+    fprintf(stderr, "Could not open input file %s: %s\n", InputFilename,
+            strerror(errno));
+    return 1;
+  }
+  if (InputFD)
+    close(InputFD);
+
+  int FD = connectTo(Socket);
+  if (FD < 0)
+    return 1;
+
+  // Report a server that goes away instead of dying of SIGPIPE
+  signal(SIGPIPE, SIG_IGN);
+
+  uint32_t Status;
+  std::string Output, Errors;
+  if (!writeField(FD, Flags) || !writeField(FD, Source) ||
+      !readU32(FD, Status) || !readField(FD, Output) ||
+      !readField(FD, Errors)) {
+    fprintf(stderr, "Lost the connection to %s\n", Socket);
+    return 1;
+  }
+  close(FD);
+
+  // Like main, write what there is when items had errors, and fail
+  fwrite(Errors.data(), 1, Errors.size(), stderr);
+  if (Status != 0 && Output.empty())
+    return 1;
+
+  int OutputFD = 1;
+  if (strcmp(OutputFilename, "-")) {
+    OutputFD = open(OutputFilename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (OutputFD < 0) {
+      fprintf(stderr, "Could not open file %s: %s\n", OutputFilename,
+              strerror(errno));
+      return 1;
+    }
+  }
+  if (!writeAll(OutputFD, Output.data(), Output.size())) {
+    fprintf(stderr, "Could not write %s: %s\n", OutputFilename,
+            strerror(errno));
+    return 1;
+  }
+  if (OutputFD != 1)
+    close(OutputFD);
+  return Status != 0;
+}
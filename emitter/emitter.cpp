@@ -0,0 +1,111 @@
+#include "emitter/emitter.h"
+#include "kaleidoscope/fastmath.h"
+
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <mutex>
+
+thread_local std::unique_ptr<llvm::TargetMachine> TheTargetMachine;
+
+std::unique_ptr<llvm::TargetMachine> CreateTargetMachine(unsigned OptLevel) {
+  // detectHost fills in the host triple, CPU name and CPU features for us
+  auto JTMB = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!JTMB) {
+    llvm::logAllUnhandledErrors(JTMB.takeError(), llvm::errs(), "Target error: ");
+    return nullptr;
+  }
+
+  // Objects are linked into position independent executables by default
+  JTMB->setRelocationModel(llvm::Reloc::PIC_);
+  setFastMathOptions(JTMB->getOptions());
+#if LLVM_VERSION_MAJOR >= 18
+  JTMB->setCodeGenOptLevel(OptLevel ? llvm::CodeGenOptLevel::Default
+                                    : llvm::CodeGenOptLevel::None);
+#else
+  JTMB->setCodeGenOptLevel(OptLevel ? llvm::CodeGenOpt::Default
+                                    : llvm::CodeGenOpt::None);
+#endif
+
+  auto TM = JTMB->createTargetMachine();
+  if (!TM) {
+    llvm::logAllUnhandledErrors(TM.takeError(), llvm::errs(), "Target error: ");
+    return nullptr;
+  }
+
+  return std::move(*TM);
+}
+
+bool InitializeTargetMachine(unsigned OptLevel) {
+  // Registering a backend is not thread safe, it happens once per process
+  static std::once_flag Registered;
+  std::call_once(Registered, [] {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeNativeTargetAsmParser();
+  });
+
+  TheTargetMachine = CreateTargetMachine(OptLevel);
+  return TheTargetMachine != nullptr;
+}
+
+void SetModuleTarget(llvm::Module &M) {
+  M.setTargetTriple(TheTargetMachine->getTargetTriple().str());
+  M.setDataLayout(TheTargetMachine->createDataLayout());
+}
+
+bool EmitModule(llvm::Module &M, EmitKind Kind, const std::string &Filename) {
+  std::error_code EC;
+  llvm::raw_fd_ostream Dest(Filename, EC,
+                            Kind == emit_obj || Kind == emit_bc
+                                ? llvm::sys::fs::OF_None
+                                : llvm::sys::fs::OF_Text);
+  if (EC) {
+    llvm::errs() << "Could not open file " << Filename << ": " << EC.message()
+                 << "\n";
+    return false;
+  }
+
+  return EmitModule(M, Kind, Dest);
+}
+
+bool EmitModule(llvm::Module &M, EmitKind Kind, llvm::raw_pwrite_stream &Dest) {
+  if (Kind == emit_ll) {
+    M.print(Dest, nullptr);
+    return true;
+  }
+
+  if (Kind == emit_bc) {
+    if (Dest.is_displayed()) {
+      llvm::errs() << "Refusing to write bitcode to a terminal, use -o\n";
+      return false;
+    }
+    llvm::WriteBitcodeToFile(M, Dest);
+    return true;
+  }
+
+#if LLVM_VERSION_MAJOR >= 18
+  auto FileType = Kind == emit_obj ? llvm::CodeGenFileType::ObjectFile
+                                   : llvm::CodeGenFileType::AssemblyFile;
+#else
+  auto FileType = Kind == emit_obj ? llvm::CGFT_ObjectFile
+                                   : llvm::CGFT_AssemblyFile;
+#endif
+
+  // The backend still runs on the legacy pass manager
+  llvm::legacy::PassManager Pass;
+  if (TheTargetMachine->addPassesToEmitFile(Pass, Dest, nullptr, FileType)) {
+    llvm::errs() << "The host target cannot emit a file of this type\n";
+    return false;
+  }
+
+  Pass.run(M);
+  Dest.flush();
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef __EMITTER_H__
+#define __EMITTER_H__
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <string>
+
+// What a compilation writes out once the whole input has been compiled
+enum EmitKind
+{
+  // Textual LLVM IR
+  emit_ll,
+
+  // Binary LLVM bitcode
+  emit_bc,
+
+  // Native assembly for the host
+  emit_asm,
+
+  // Native object file for the host
+  emit_obj
+};
+
+// The TargetMachine describing the host, used to pick the module's triple
+// and data layout, to tune the optimizer and to emit native code. A
+// TargetMachine must not be shared between threads, so every thread that
+// generates code has its own
+extern thread_local std::unique_ptr<llvm::TargetMachine> TheTargetMachine;
+
+// Registers the host backend on the first call and creates TheTargetMachine
+// for the calling thread, returns false if LLVM has no backend for the host
+bool InitializeTargetMachine(unsigned OptLevel);
+
+// Creates another TargetMachine for the host, e.g. for a worker thread once
+// InitializeTargetMachine has registered the backend. Returns null and logs
+// the reason on failure
+std::unique_ptr<llvm::TargetMachine> CreateTargetMachine(unsigned OptLevel);
+
+// Stamps the host triple and data layout on a module before code is
+// generated into it
+void SetModuleTarget(llvm::Module &M);
+
+// Writes M to Filename ("-" for stdout) in the requested form, returns false
+// and logs the reason on failure
+bool EmitModule(llvm::Module &M, EmitKind Kind, const std::string &Filename);
+
+// Same as above for an open stream, e.g. a buffer in memory
+bool EmitModule(llvm::Module &M, EmitKind Kind, llvm::raw_pwrite_stream &Dest);
+
+#endif
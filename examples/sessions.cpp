@@ -0,0 +1,142 @@
+// Compiles several programs at once, each many times over on threads of
+// its own, through the CompilerSession API, checks that every thread got
+// the same bitcode for the same program, links one copy of each into a
+// module and adds a main that prints what their functions compute
+#include "kaleidoscope/kaleidoscope.h"
+#include "session/session.h"
+
+// LLVM headers
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+// stdlib headers
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char *const Programs[] = {
+    "def fib(x) if x < 3 then 1 else fib(x - 1) + fib(x - 2);",
+
+    "def binary : 1 (x y) y;\n"
+    "def sumto(n) var s = 0 in (for i = 1, i < n in s = s + i) : s;",
+
+    "def unary - (v) 0 - v;\n"
+    "def binary > 10 (l r) r < l;\n"
+    "def absval(x) if x > 0 then x else -x;",
+
+    "def binary : 1 (x y: i64): i64 y;\n"
+    "def square(x: i64): i64 x * x;\n"
+    "def sumsquares(n: i64): i64\n"
+    "  var s: i64 = 0 in (for i: i64 = 1, i < n in s = s + square(i)) : s;",
+};
+
+static const unsigned NumPrograms = sizeof(Programs) / sizeof(Programs[0]);
+static const unsigned ThreadsPerProgram = 4;
+static const unsigned CompilesPerThread = 25;
+
+// What one thread made of its program, the bitcode of every compile
+struct ThreadResult
+{
+  std::vector<std::string> Bitcode;
+  unsigned NumErrors = 0;
+};
+
+static void compileMany(unsigned Program, ThreadResult &Result)
+{
+  CompilerOptions Options;
+  Options.OptLevel = 2;
+  CompilerSession Session(Options);
+
+  for (unsigned i = 0; i != CompilesPerThread; ++i)
+  {
+    llvm::SmallVector<char, 0> Out;
+    llvm::raw_svector_ostream OS(Out);
+    auto Source = llvm::MemoryBuffer::getMemBuffer(Programs[Program], "program");
+    Session.compile(std::move(Source), emit_bc, OS);
+    Result.Bitcode.emplace_back(Out.begin(), Out.end());
+    Result.NumErrors += Session.getNumErrors();
+  }
+}
+
+// Declares printf and adds main, which prints fn(arg) for every call
+static void generateMain()
+{
+  llvm::FunctionType *printfType = llvm::FunctionType::get(
+      Builder.getInt32Ty(), {llvm::PointerType::getUnqual(Builder.getInt8Ty())}, true);
+  llvm::FunctionCallee funcPrintf = TheModule->getOrInsertFunction("printf", printfType);
+
+  llvm::FunctionType *mainType = llvm::FunctionType::get(Builder.getInt32Ty(), false);
+  llvm::Function *func = llvm::Function::Create(mainType, llvm::Function::ExternalLinkage, "main", TheModule.get());
+  Builder.SetInsertPoint(llvm::BasicBlock::Create(TheContext, "entry", func));
+
+  llvm::Value *format = Builder.CreateGlobalStringPtr("%s(%d) = %g\n");
+  for (const char *name : {"fib", "sumto", "absval", "sumsquares"})
+  {
+    llvm::Function *callee = TheModule->getFunction(name);
+    for (int arg : {-7, 10})
+    {
+      llvm::Type *argType = callee->getFunctionType()->getParamType(0);
+      llvm::Value *argValue = argType->isDoubleTy()
+                                  ? (llvm::Value *)llvm::ConstantFP::get(argType, arg)
+                                  : llvm::ConstantInt::get(argType, arg);
+      llvm::Value *result = Builder.CreateCall(callee, {argValue});
+      if (!result->getType()->isDoubleTy())
+        result = Builder.CreateSIToFP(result, Builder.getDoubleTy());
+      Builder.CreateCall(funcPrintf, {format, Builder.CreateGlobalStringPtr(name),
+                                      Builder.getInt32(arg), result});
+    }
+  }
+  Builder.CreateRet(Builder.getInt32(0));
+
+  verifyFunction(*func);
+}
+
+int main()
+{
+  std::vector<ThreadResult> Results(NumPrograms * ThreadsPerProgram);
+  std::vector<std::thread> Threads;
+  for (unsigned i = 0; i != Results.size(); ++i)
+    Threads.emplace_back(compileMany, i % NumPrograms, std::ref(Results[i]));
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  TheModule = std::make_unique<llvm::Module>("sessions.codegen.ll", TheContext);
+  for (unsigned Program = 0; Program != NumPrograms; ++Program)
+  {
+    const std::string &First = Results[Program].Bitcode.front();
+    for (unsigned i = Program; i < Results.size(); i += NumPrograms)
+    {
+      if (Results[i].NumErrors)
+      {
+        fprintf(stderr, "program %u did not compile\n", Program);
+        return 1;
+      }
+      for (const std::string &Bitcode : Results[i].Bitcode)
+        if (Bitcode != First)
+        {
+          fprintf(stderr, "program %u compiled differently on thread %u\n", Program, i);
+          return 1;
+        }
+    }
+
+    auto M = llvm::parseBitcodeFile(llvm::MemoryBufferRef(First, "program"), TheContext);
+    if (!M)
+      llvm::consumeError(M.takeError());
+    if (!M || llvm::Linker::linkModules(*TheModule, std::move(*M)))
+    {
+      fprintf(stderr, "program %u could not be linked\n", Program);
+      return 1;
+    }
+  }
+
+  generateMain();
+  TheModule->print(llvm::outs(), nullptr);
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include "jit/jit.h"
+#include "kaleidoscope/fastmath.h"
+#include "kaleidoscope/kaleidoscope.h"
+#include "optimizer/optimizer.h"
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/TargetSelect.h"
+
+std::unique_ptr<llvm::orc::LLLazyJIT> TheJIT;
+
+// Whether definitions are compiled on their first call, see InitializeJIT
+static bool LazyJIT = false;
+
+static llvm::ExitOnError ExitOnErr("JIT error: ");
+
+// Every module handed to the JIT must agree with it on the data layout
+static void ResetModule() {
+  InitializeModule();
+  TheModule->setDataLayout(TheJIT->getDataLayout());
+}
+
+// Optimizes a module as the JIT compiles it, which for a lazily added
+// definition is when one of its functions is first called. The compile
+// happens on the thread that needs the function, the one running the
+// program
+static llvm::Expected<llvm::orc::ThreadSafeModule>
+OptimizeOnCompile(llvm::orc::ThreadSafeModule TSM,
+                  llvm::orc::MaterializationResponsibility &) {
+  if (LazyJIT)
+    TSM.withModuleDo([](llvm::Module &M) { OptimizeModule(M); });
+  return TSM;
+}
+
+void InitializeJIT(bool Lazy) {
+  LazyJIT = Lazy;
+  if (TheJIT) {
+    ResetModule();
+    return;
+  }
+
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  llvm::InitializeNativeTargetAsmParser();
+
+  auto JTMB = ExitOnErr(llvm::orc::JITTargetMachineBuilder::detectHost());
+  setFastMathOptions(JTMB.getOptions());
+  TheJIT = ExitOnErr(llvm::orc::LLLazyJITBuilder()
+                         .setJITTargetMachineBuilder(std::move(JTMB))
+                         .create());
+  TheJIT->getIRTransformLayer().setTransform(OptimizeOnCompile);
+
+  // Resolve externs against the symbols of the host process, this is how
+  // "extern sin(x)" finds libm and "extern putchard(x)" finds main.cpp
+  char Prefix = TheJIT->getDataLayout().getGlobalPrefix();
+  TheJIT->getMainJITDylib().addGenerator(ExitOnErr(
+      llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(Prefix)));
+
+  ResetModule();
+}
+
+void AddModuleToJIT() {
+  llvm::orc::ThreadSafeModule TSM(std::move(TheModule), TheTSContext);
+  if (LazyJIT) {
+    // Every function of the module is compiled on its own when first called
+    ExitOnErr(TheJIT->addLazyIRModule(std::move(TSM)));
+  } else {
+    TSM.withModuleDo([](llvm::Module &M) { OptimizeModule(M); });
+    ExitOnErr(TheJIT->addIRModule(std::move(TSM)));
+  }
+  ResetModule();
+}
+
+double RunTopLevelExpr(llvm::StringRef Name) {
+  // Name lives in TheModule, which is about to go
+  std::string Expr = Name.str();
+
+  // Track the module separately so its memory can be freed once it has run
+  auto RT = TheJIT->getMainJITDylib().createResourceTracker();
+  if (!LazyJIT)
+    OptimizeModule(*TheModule);
+  ExitOnErr(TheJIT->addIRModule(
+      RT, llvm::orc::ThreadSafeModule(std::move(TheModule), TheTSContext)));
+  ResetModule();
+
+  auto Sym = ExitOnErr(TheJIT->lookup(Expr));
+#if LLVM_VERSION_MAJOR >= 15
+  double (*FP)() = Sym.toPtr<double (*)()>();
+#else
+  double (*FP)() = (double (*)())(intptr_t)Sym.getAddress();
+#endif
+  double Result = FP();
+
+  ExitOnErr(RT->remove());
+  return Result;
+}
@@ -0,0 +1,25 @@
+#ifndef __JIT_H__
+#define __JIT_H__
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+
+// The in-process JIT used by --jit, it stays null when main only prints IR.
+// There is one for the whole process, so only one thread may use it
+extern std::unique_ptr<llvm::orc::LLLazyJIT> TheJIT;
+
+// Creates TheJIT for the host on the first call, and starts a new TheModule
+// with its data layout. With Lazy the functions of later definitions are
+// optimized and compiled to machine code the first time they are called,
+// through a stub that ORC then points at the compiled body; otherwise they
+// are optimized as soon as they are added
+void InitializeJIT(bool Lazy);
+
+// Moves TheModule into the JIT for good and starts a new one, so that later
+// items can call the functions it defines
+void AddModuleToJIT();
+
+// Moves TheModule into the JIT, runs the top-level expression Name it holds
+// and throws the module away again
+double RunTopLevelExpr(llvm::StringRef Name);
+
+#endif
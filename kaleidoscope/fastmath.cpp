@@ -0,0 +1,33 @@
+#include "kaleidoscope/fastmath.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/Target/TargetOptions.h"
+
+thread_local llvm::FastMathFlags TheFastMathFlags;
+
+thread_local bool FlushDenormals = false;
+
+void addFastMathAttributes(llvm::Function &F) {
+  auto SetIf = [&F](bool Enabled, const char *Kind) {
+    if (Enabled)
+      F.addFnAttr(Kind, "true");
+  };
+  SetIf(TheFastMathFlags.noNaNs(), "no-nans-fp-math");
+  SetIf(TheFastMathFlags.noInfs(), "no-infs-fp-math");
+  SetIf(TheFastMathFlags.noSignedZeros(), "no-signed-zeros-fp-math");
+  SetIf(TheFastMathFlags.approxFunc(), "approx-func-fp-math");
+  // What clang calls -funsafe-math-optimizations
+  SetIf(TheFastMathFlags.allowReassoc() && TheFastMathFlags.noSignedZeros() &&
+            TheFastMathFlags.allowReciprocal(),
+        "unsafe-fp-math");
+
+  if (FlushDenormals) {
+    F.addFnAttr("denormal-fp-math", "preserve-sign,preserve-sign");
+    F.addFnAttr("denormal-fp-math-f32", "preserve-sign,preserve-sign");
+  }
+}
+
+void setFastMathOptions(llvm::TargetOptions &Options) {
+  if (TheFastMathFlags.allowContract())
+    Options.AllowFPOpFusion = llvm::FPOpFusion::Fast;
+}
@@ -0,0 +1,31 @@
+#ifndef __FASTMATH_H__
+#define __FASTMATH_H__
+
+#include "llvm/IR/Operator.h"
+
+namespace llvm {
+class Function;
+class TargetOptions;
+}
+
+// Floating point semantics are strict IEEE unless --fast-math or --fp-flags
+// relax them. These are set per thread before any code is generated, the
+// workers of GenerateInParallel take them over from the thread that starts
+// them
+
+// The fast-math flags of every floating point instruction codegen emits,
+// InitializeModule puts them on Builder
+extern thread_local llvm::FastMathFlags TheFastMathFlags;
+
+// Whether denormal inputs and results may be treated as zero. This only
+// tells LLVM what it may assume, the host decides whether the hardware
+// actually flushes them
+extern thread_local bool FlushDenormals;
+
+// Adds the function attributes the backend reads the same relaxations from
+void addFastMathAttributes(llvm::Function &F);
+
+// Lets the backend fuse multiplies and adds into FMAs if contraction is on
+void setFastMathOptions(llvm::TargetOptions &Options);
+
+#endif
@@ -1,30 +1,40 @@
 #include "kaleidoscope.h"
+#include "kaleidoscope/fastmath.h"
+
+// This owns the LLVMContext below, it lets modules be handed to the JIT
+// without copying them into a context of their own
+thread_local llvm::orc::ThreadSafeContext TheTSContext(std::make_unique<llvm::LLVMContext>());
 
 // This is an object that owns LLVM core data structures
-llvm::LLVMContext TheContext;
+thread_local llvm::LLVMContext &TheContext = *TheTSContext.getContext();
 
 // This is a helper object that makes easy to generate LLVM instructions
-llvm::IRBuilder<> Builder(TheContext);
+thread_local llvm::IRBuilder<> Builder(TheContext);
 
 // This is an LLVM construct that contains functions and global variables
-std::unique_ptr<llvm::Module> TheModule;
+thread_local std::unique_ptr<llvm::Module> TheModule;
 
-// This map keeps track of which values are defined in the current scope
-std::map<std::string, llvm::AllocaInst*> NamedValues;
+// The latest prototype seen for every function, used to redeclare functions
+// in modules other than the one that defined them
+static thread_local PrototypeMap OwnFunctionProtos;
+thread_local PrototypeMap *FunctionProtos = &OwnFunctionProtos;
 
-std::map<std::string, std::unique_ptr<PrototypeAST>> FunctionProtos;
+void InitializeModule() {
+  TheModule = std::make_unique<llvm::Module>("My awesome JIT", TheContext);
+  Builder.setFastMathFlags(TheFastMathFlags);
+}
 
-llvm::Function *getFunction(std::string Name) {
+llvm::Function *getFunction(Symbol Name) {
   // First, see if the function has already been added to the current module.
-  if (auto *F = TheModule->getFunction(Name))
+  if (auto *F = TheModule->getFunction(Name.getName()))
     return F;
 
   // If not, check whether we can codegen the declaration from some existing
   // prototype.
-  auto FI = FunctionProtos.find(Name);
-  if (FI != FunctionProtos.end())
+  auto FI = FunctionProtos->find(Name);
+  if (FI != FunctionProtos->end())
     return FI->second->codegen();
 
   // If no existing prototype exists, return null.
   return nullptr;
-}
\ No newline at end of file
+}
@@ -13,24 +13,40 @@
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/ADT/DenseMap.h"
 #include "ast/PrototypeAST.h"
+#include "lexer/symbol.h"
 
-#include <map>
+// The context, builder and module that codegen works on are per thread, so
+// that functions can be generated on several threads at once (see
+// parallel/parallel.h). Single threaded runs only ever see one of each
+
+// This owns TheContext so that finished modules can be moved into the JIT
+extern thread_local llvm::orc::ThreadSafeContext TheTSContext;
 
 // This is an object that owns LLVM core data structures
-extern llvm::LLVMContext TheContext;
+extern thread_local llvm::LLVMContext &TheContext;
 
 // This is a helper object that makes easy to generate LLVM instructions
-extern llvm::IRBuilder<> Builder;
+extern thread_local llvm::IRBuilder<> Builder;
 
 // This is an LLVM construct that contains functions and global variables
-extern std::unique_ptr<llvm::Module> TheModule;
+extern thread_local std::unique_ptr<llvm::Module> TheModule;
+
+typedef llvm::DenseMap<Symbol, std::unique_ptr<PrototypeAST>> PrototypeMap;
 
-// This map keeps track of which values are defined in the current scope
-extern std::map<std::string, llvm::AllocaInst*> NamedValues;
+// The latest prototype seen for every function, used to redeclare functions
+// in modules other than the one that defined them. Like the symbol table
+// every thread has a map of its own unless pointed elsewhere: the workers
+// of GenerateInParallel use the map of the thread that parsed, which is
+// only read while they run
+extern thread_local PrototypeMap *FunctionProtos;
 
-extern std::map<std::string, std::unique_ptr<PrototypeAST>> FunctionProtos;
+// Starts a new, empty TheModule in the calling thread's TheContext, with
+// Builder set up to emit TheFastMathFlags
+void InitializeModule();
 
-llvm::Function *getFunction(std::string Name);
+llvm::Function *getFunction(Symbol Name);
 
 #endif
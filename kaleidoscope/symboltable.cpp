@@ -0,0 +1,106 @@
+#include "kaleidoscope/symboltable.h"
+
+#include <cassert>
+
+// Functions rarely have more variables than this, so most never rehash
+static const unsigned InitialSlotBits = 6;
+
+ScopedSymbolTable::ScopedSymbolTable()
+    : Slots(1u << InitialSlotBits), SlotShift(32 - InitialSlotBits) {}
+
+// Symbol ids are handed out sequentially, so spread them with a Fibonacci
+// hash and take the top bits
+unsigned ScopedSymbolTable::getHomeSlot(Symbol Name) const {
+  return (Name.getId() * 2654435769u) >> SlotShift;
+}
+
+const ScopedSymbolTable::Slot *ScopedSymbolTable::findSlot(Symbol Name) const {
+  unsigned Mask = Slots.size() - 1;
+  for (unsigned I = getHomeSlot(Name);; I = (I + 1) & Mask) {
+    const Slot &S = Slots[I];
+    if (!isUsed(S))
+      return nullptr;
+    if (S.Name == Name)
+      return &S;
+  }
+}
+
+ScopedSymbolTable::Slot *ScopedSymbolTable::findSlot(Symbol Name) {
+  return const_cast<Slot *>(
+      static_cast<const ScopedSymbolTable *>(this)->findSlot(Name));
+}
+
+ScopedSymbolTable::Slot &ScopedSymbolTable::findOrInsertSlot(Symbol Name) {
+  // Keep the load factor under 3/4 so probe sequences stay short
+  if ((NumUsedSlots + 1) * 4 > Slots.size() * 3)
+    grow();
+
+  unsigned Mask = Slots.size() - 1;
+  for (unsigned I = getHomeSlot(Name);; I = (I + 1) & Mask) {
+    Slot &S = Slots[I];
+    if (!isUsed(S)) {
+      S.Name = Name;
+      S.Generation = Generation;
+      S.Binding = NoBinding;
+      ++NumUsedSlots;
+      return S;
+    }
+    if (S.Name == Name)
+      return S;
+  }
+}
+
+void ScopedSymbolTable::grow() {
+  std::vector<Slot> OldSlots(Slots.size() * 2);
+  OldSlots.swap(Slots);
+  --SlotShift;
+
+  unsigned Mask = Slots.size() - 1;
+  for (const Slot &Old : OldSlots) {
+    if (!isUsed(Old))
+      continue;
+    unsigned I = getHomeSlot(Old.Name);
+    while (isUsed(Slots[I]))
+      I = (I + 1) & Mask;
+    Slots[I] = Old;
+  }
+}
+
+void ScopedSymbolTable::clear() {
+  // On wrap-around old stamps could look current again, so wipe them
+  if (++Generation == 0) {
+    for (Slot &S : Slots)
+      S.Generation = 0;
+    Generation = 1;
+  }
+  NumUsedSlots = 0;
+  Bindings.clear();
+  Scopes.clear();
+}
+
+void ScopedSymbolTable::pushScope() { Scopes.push_back(Bindings.size()); }
+
+void ScopedSymbolTable::popScope() {
+  assert(!Scopes.empty() && "popScope without pushScope");
+  unsigned Mark = Scopes.back();
+  Scopes.pop_back();
+
+  while (Bindings.size() > Mark) {
+    const Binding &B = Bindings.back();
+    findSlot(B.Name)->Binding = B.Shadowed;
+    Bindings.pop_back();
+  }
+}
+
+void ScopedSymbolTable::bind(Symbol Name, llvm::AllocaInst *Value) {
+  Slot &S = findOrInsertSlot(Name);
+  Bindings.push_back({Name, Value, S.Binding});
+  S.Binding = Bindings.size() - 1;
+}
+
+llvm::AllocaInst *ScopedSymbolTable::lookup(Symbol Name) const {
+  const Slot *S = findSlot(Name);
+  if (!S || S->Binding == NoBinding)
+    return nullptr;
+  return Bindings[S->Binding].Value;
+}
@@ -0,0 +1,75 @@
+#ifndef __SYMBOL_TABLE_H__
+#define __SYMBOL_TABLE_H__
+
+#include "lexer/symbol.h"
+
+#include <vector>
+
+namespace llvm {
+class AllocaInst;
+}
+
+// ScopedSymbolTable - Maps variable symbols to their allocas while a
+// function is being generated, with lexical scoping for 'for' and 'var'.
+//
+// Bindings are appended to a stack and every symbol's slot in an
+// open-addressed hash table points at its innermost binding, which in turn
+// remembers the binding it shadows. Opening a scope just records the stack
+// height; closing it walks the scope's bindings back and restores what they
+// shadowed. Nothing is allocated per binding once the vectors have grown,
+// and clear() forgets everything in O(1) by bumping a generation counter.
+//
+// One table is owned by each compilation and reused for every function.
+class ScopedSymbolTable {
+  static const unsigned NoBinding = ~0u;
+
+  struct Slot {
+    Symbol Name;
+    // Slots from an older generation are empty
+    unsigned Generation = 0;
+    // Index of the innermost binding of Name, NoBinding when it is unbound
+    unsigned Binding = NoBinding;
+  };
+
+  struct Binding {
+    Symbol Name;
+    llvm::AllocaInst *Value;
+    // The binding of Name this one shadows, or NoBinding
+    unsigned Shadowed;
+  };
+
+  // Power-of-two sized, linearly probed
+  std::vector<Slot> Slots;
+  unsigned SlotShift;
+  unsigned NumUsedSlots = 0;
+  unsigned Generation = 1;
+
+  std::vector<Binding> Bindings;
+  // Bindings.size() at every open scope
+  std::vector<unsigned> Scopes;
+
+  bool isUsed(const Slot &S) const { return S.Generation == Generation; }
+  unsigned getHomeSlot(Symbol Name) const;
+  Slot *findSlot(Symbol Name);
+  const Slot *findSlot(Symbol Name) const;
+  Slot &findOrInsertSlot(Symbol Name);
+  void grow();
+
+public:
+  ScopedSymbolTable();
+
+  // Forgets all bindings and scopes, done at the start of every function
+  void clear();
+
+  void pushScope();
+  // Unbinds everything bound since the matching pushScope
+  void popScope();
+
+  // Binds Name in the innermost scope, shadowing any outer binding
+  void bind(Symbol Name, llvm::AllocaInst *Value);
+
+  // Returns the innermost binding of Name, or null if it is not bound
+  llvm::AllocaInst *lookup(Symbol Name) const;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "kaleidoscope/types.h"
+#include "kaleidoscope/kaleidoscope.h"
+
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#include <cassert>
+#include <cstdint>
+
+const char *getTypeName(ValueType Ty) {
+  switch (Ty) {
+  case type_f64:
+    return "f64";
+  case type_f32:
+    return "f32";
+  case type_i64:
+    return "i64";
+  case type_bool:
+    return "bool";
+  case type_vec2:
+    return "vec2";
+  case type_vec4:
+    return "vec4";
+  case type_vec8:
+    return "vec8";
+  case type_vec16:
+    return "vec16";
+  case type_f64_array:
+    return "f64[]";
+  case type_f32_array:
+    return "f32[]";
+  case type_i64_array:
+    return "i64[]";
+  case type_inferred:
+    break;
+  }
+  llvm_unreachable("no value has an inferred type");
+}
+
+bool lookupType(llvm::StringRef Name, ValueType &Ty) {
+  for (ValueType T : {type_f64, type_f32, type_i64, type_bool, type_vec2,
+                      type_vec4, type_vec8, type_vec16}) {
+    if (Name == getTypeName(T)) {
+      Ty = T;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isFloatingPoint(ValueType Ty) {
+  return Ty == type_f64 || Ty == type_f32 || isVector(Ty);
+}
+
+bool isVector(ValueType Ty) { return getNumLanes(Ty) > 1; }
+
+unsigned getNumLanes(ValueType Ty) {
+  switch (Ty) {
+  case type_vec2:
+    return 2;
+  case type_vec4:
+    return 4;
+  case type_vec8:
+    return 8;
+  case type_vec16:
+    return 16;
+  default:
+    return 1;
+  }
+}
+
+bool isArray(ValueType Ty) {
+  return Ty == type_f64_array || Ty == type_f32_array || Ty == type_i64_array;
+}
+
+bool isScalar(ValueType Ty) { return !isVector(Ty) && !isArray(Ty); }
+
+ValueType getElementType(ValueType Ty) {
+  switch (Ty) {
+  case type_f64_array:
+    return type_f64;
+  case type_f32_array:
+    return type_f32;
+  case type_i64_array:
+    return type_i64;
+  default:
+    llvm_unreachable("not an array type");
+  }
+}
+
+bool getArrayType(ValueType Element, ValueType &Ty) {
+  for (ValueType T : {type_f64_array, type_f32_array, type_i64_array}) {
+    if (getElementType(T) == Element) {
+      Ty = T;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool getVectorType(unsigned Lanes, ValueType &Ty) {
+  for (ValueType T : {type_vec2, type_vec4, type_vec8, type_vec16}) {
+    if (getNumLanes(T) == Lanes) {
+      Ty = T;
+      return true;
+    }
+  }
+  return false;
+}
+
+llvm::Type *getLLVMType(ValueType Ty) {
+  switch (Ty) {
+  case type_f64:
+    return llvm::Type::getDoubleTy(TheContext);
+  case type_f32:
+    return llvm::Type::getFloatTy(TheContext);
+  case type_i64:
+    return llvm::Type::getInt64Ty(TheContext);
+  case type_bool:
+    return llvm::Type::getInt1Ty(TheContext);
+  case type_vec2:
+  case type_vec4:
+  case type_vec8:
+  case type_vec16:
+    return llvm::FixedVectorType::get(llvm::Type::getDoubleTy(TheContext),
+                                      getNumLanes(Ty));
+  case type_f64_array:
+  case type_f32_array:
+  case type_i64_array:
+    return llvm::PointerType::getUnqual(getLLVMType(getElementType(Ty)));
+  case type_inferred:
+    break;
+  }
+  llvm_unreachable("no value has an inferred type");
+}
+
+llvm::Value *getConstant(ValueType Ty, double Val) {
+  switch (Ty) {
+  case type_f64:
+  case type_f32:
+  case type_vec2:
+  case type_vec4:
+  case type_vec8:
+  case type_vec16:
+    return llvm::ConstantFP::get(getLLVMType(Ty), Val);
+  case type_i64:
+    return llvm::ConstantInt::get(getLLVMType(Ty), (uint64_t)(int64_t)Val);
+  case type_bool:
+    return llvm::ConstantInt::getBool(TheContext, Val != 0);
+  case type_f64_array:
+  case type_f32_array:
+  case type_i64_array:
+    assert(Val == 0 && "arrays have no constants but null");
+    return llvm::ConstantPointerNull::get(
+        llvm::cast<llvm::PointerType>(getLLVMType(Ty)));
+  case type_inferred:
+    break;
+  }
+  llvm_unreachable("no value has an inferred type");
+}
+
+llvm::Value *emitConversion(llvm::Value *V, ValueType From, ValueType To,
+                            const llvm::Twine &Name) {
+  if (From == To)
+    return V;
+
+  assert(isScalar(From) && !isArray(To) && "only scalars can be converted");
+  if (isVector(To)) {
+    V = emitConversion(V, From, type_f64);
+    return Builder.CreateVectorSplat(getNumLanes(To), V, Name);
+  }
+
+  llvm::Type *ToTy = getLLVMType(To);
+  if (To == type_bool) {
+    // Unordered compares would make NaN true
+    if (isFloatingPoint(From))
+      return Builder.CreateFCmpONE(V, llvm::Constant::getNullValue(V->getType()),
+                                   Name);
+    return Builder.CreateICmpNE(V, llvm::Constant::getNullValue(V->getType()),
+                                Name);
+  }
+
+  if (From == type_bool)
+    return To == type_i64 ? Builder.CreateZExt(V, ToTy, Name)
+                          : Builder.CreateUIToFP(V, ToTy, Name);
+
+  if (From == type_i64)
+    return Builder.CreateSIToFP(V, ToTy, Name);
+
+  if (To == type_i64)
+    return Builder.CreateIntrinsic(llvm::Intrinsic::fptosi_sat,
+                                   {ToTy, V->getType()}, {V}, nullptr, Name);
+
+  return To == type_f64 ? Builder.CreateFPExt(V, ToTy, Name)
+                        : Builder.CreateFPTrunc(V, ToTy, Name);
+}
@@ -0,0 +1,85 @@
+#ifndef __TYPES_H__
+#define __TYPES_H__
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+
+namespace llvm {
+class Type;
+class Value;
+}
+
+// The types a value can have. Anything without an annotation is an f64,
+// so programs written before there were types mean what they used to
+enum ValueType
+{
+  type_f64,
+  type_f32,
+  type_i64,
+
+  // The result of '<', an i1 in the IR. It widens to 0 or 1 wherever a
+  // number is expected
+  type_bool,
+
+  // SIMD vectors of f64, <N x double> in the IR. Arithmetic on them is
+  // element-wise and scalars are splat to all lanes when mixed with them
+  type_vec2,
+  type_vec4,
+  type_vec8,
+  type_vec16,
+
+  // Arrays of the host's memory, passed as pointers to their first
+  // element. They can only be indexed, assigned and passed on
+  type_f64_array,
+  type_f32_array,
+  type_i64_array,
+
+  // Stands for a missing annotation on a 'var' or 'for' variable, whose
+  // type then comes from its initializer. No value ever has it
+  type_inferred
+};
+
+// The name annotations use for Ty
+const char *getTypeName(ValueType Ty);
+
+// Sets Ty to the type called Name, returns false if there is none
+bool lookupType(llvm::StringRef Name, ValueType &Ty);
+
+// True for f64, f32 and the vectors, whose lanes are f64s
+bool isFloatingPoint(ValueType Ty);
+
+bool isVector(ValueType Ty);
+
+// The number of lanes of a vector type, 1 for scalars
+unsigned getNumLanes(ValueType Ty);
+
+// Sets Ty to the vector type with Lanes lanes, returns false if there is none
+bool getVectorType(unsigned Lanes, ValueType &Ty);
+
+bool isArray(ValueType Ty);
+
+// Neither a vector nor an array
+bool isScalar(ValueType Ty);
+
+// The type of the elements of an array type
+ValueType getElementType(ValueType Ty);
+
+// Sets Ty to the type of arrays of Element, returns false if there is none
+bool getArrayType(ValueType Element, ValueType &Ty);
+
+// The IR type of Ty in TheContext
+llvm::Type *getLLVMType(ValueType Ty);
+
+// Returns the constant of type Ty closest to Val, see NumberExprAST. For
+// vectors that is Val in every lane, arrays can only be null (Val = 0)
+llvm::Value *getConstant(ValueType Ty, double Val);
+
+// Converts V from From to To at Builder's insertion point. Floating point
+// values become i64s by truncation, saturating at its limits, with NaN
+// becoming 0; anything is true as a bool unless it is zero or NaN. Scalars
+// are converted to f64 and splat when To is a vector, vectors and arrays
+// cannot be converted to anything else
+llvm::Value *emitConversion(llvm::Value *V, ValueType From, ValueType To,
+                            const llvm::Twine &Name = "");
+
+#endif
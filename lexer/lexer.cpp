@@ -1,133 +1,226 @@
 #include "lexer/lexer.h"
 #include "lexer/token.h"
+#include "lexer/scanner.h"
+#include "stats/stats.h"
 
-int CurTok;
-std::string IdentifierStr;
-double NumVal;
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstring>
+
+thread_local int CurTok;
+thread_local TokenSpan CurTokSpan;
+thread_local llvm::StringRef IdentifierStr;
+thread_local Symbol IdentifierSym;
+thread_local double NumVal;
+
+// The source text and the lexer's position in it
+static thread_local std::unique_ptr<llvm::MemoryBuffer> SourceBuffer;
+static thread_local const char *CurPtr;
+static thread_local const char *BufferEnd;
+
+std::unique_ptr<llvm::MemoryBuffer> ReadSource(const std::string &Filename)
+{
+  auto BufferOrErr = llvm::MemoryBuffer::getFileOrSTDIN(Filename);
+  if (!BufferOrErr)
+  {
+    llvm::errs() << "Could not read " << Filename << ": "
+                 << BufferOrErr.getError().message() << "\n";
+    return nullptr;
+  }
+  return std::move(*BufferOrErr);
+}
+
+bool InitializeLexer(const std::string &Filename)
+{
+  auto Buffer = ReadSource(Filename);
+  if (!Buffer)
+    return false;
+
+  InitializeLexer(std::move(Buffer));
+  return true;
+}
+
+void InitializeLexer(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+{
+  SourceBuffer = std::move(Buffer);
+  CurPtr = SourceBuffer->getBufferStart();
+  BufferEnd = SourceBuffer->getBufferEnd();
+}
+
+llvm::StringRef getSpanText(TokenSpan Span)
+{
+  return SourceBuffer->getBuffer().substr(Span.Offset, Span.Length);
+}
+
+static bool isAlphaChar(char C) { return isalpha((unsigned char)C); }
+static bool isNumberChar(char C) { return isdigit((unsigned char)C) || C == '.'; }
+
+// Keywords are recognized with a perfect hash that is checked at compile
+// time: every keyword lands in its own slot of a 32 entry table, so an
+// identifier costs one hash and at most one memcmp
+struct Keyword
+{
+  const char *Name;
+  size_t Length;
+  int Tok;
+};
+
+static constexpr size_t constLength(const char *S)
+{
+  size_t Len = 0;
+  while (S[Len])
+    ++Len;
+  return Len;
+}
+
+#define KEYWORD(Name, Tok) {Name, constLength(Name), Tok}
+static constexpr Keyword Keywords[] = {
+    KEYWORD("def", tok_def),       KEYWORD("extern", tok_extern),
+    KEYWORD("if", tok_if),         KEYWORD("then", tok_then),
+    KEYWORD("else", tok_else),     KEYWORD("for", tok_for),
+    KEYWORD("in", tok_in),         KEYWORD("binary", tok_binary),
+    KEYWORD("unary", tok_unary),   KEYWORD("var", tok_var),
+    KEYWORD("as", tok_as),         KEYWORD("pure", tok_pure)};
+#undef KEYWORD
+
+static constexpr size_t NumKeywords = sizeof(Keywords) / sizeof(Keywords[0]);
+static constexpr size_t KeywordTableSize = 32;
+
+// Only looks at the first two characters and the length, all keywords have
+// at least two characters
+static constexpr size_t hashKeyword(const char *S, size_t Len)
+{
+  return ((unsigned char)S[0] * 3 + (unsigned char)S[1] * 6 + Len) &
+         (KeywordTableSize - 1);
+}
+
+struct KeywordTable
+{
+  // Index into Keywords, or -1 for an empty slot
+  int Slot[KeywordTableSize];
+  size_t MinLength;
+  size_t MaxLength;
+};
+
+static constexpr KeywordTable buildKeywordTable()
+{
+  KeywordTable Table{};
+  for (size_t i = 0; i != KeywordTableSize; ++i)
+    Table.Slot[i] = -1;
+
+  Table.MinLength = Keywords[0].Length;
+  Table.MaxLength = Keywords[0].Length;
+  for (size_t i = 0; i != NumKeywords; ++i)
+  {
+    Table.Slot[hashKeyword(Keywords[i].Name, Keywords[i].Length)] = i;
+    if (Keywords[i].Length < Table.MinLength)
+      Table.MinLength = Keywords[i].Length;
+    if (Keywords[i].Length > Table.MaxLength)
+      Table.MaxLength = Keywords[i].Length;
+  }
+  return Table;
+}
+
+static constexpr KeywordTable KeywordSlots = buildKeywordTable();
+
+// A later keyword overwriting an earlier one's slot would show up here
+static constexpr bool isPerfectHash()
+{
+  for (size_t i = 0; i != NumKeywords; ++i)
+    if (KeywordSlots.Slot[hashKeyword(Keywords[i].Name, Keywords[i].Length)] != (int)i)
+      return false;
+  return KeywordSlots.MinLength >= 2;
+}
+
+static_assert(isPerfectHash(), "keyword hash has collisions, pick new factors");
+
+// Returns the keyword token for Id, or tok_identifier if it is not one
+static int getKeywordToken(llvm::StringRef Id)
+{
+  if (Id.size() < KeywordSlots.MinLength || Id.size() > KeywordSlots.MaxLength)
+    return tok_identifier;
+
+  int Slot = KeywordSlots.Slot[hashKeyword(Id.data(), Id.size())];
+  if (Slot < 0)
+    return tok_identifier;
+
+  const Keyword &K = Keywords[Slot];
+  if (Id.size() != K.Length || memcmp(Id.data(), K.Name, K.Length) != 0)
+    return tok_identifier;
+  return K.Tok;
+}
+
+// Records the span of the token that started at TokStart and ends at CurPtr
+static int formToken(const char *TokStart, int Tok)
+{
+  CurTokSpan.Offset = TokStart - SourceBuffer->getBufferStart();
+  CurTokSpan.Length = CurPtr - TokStart;
+  return Tok;
+}
 
 // The actual implementation of the lexer is a single function gettok()
-// It's called to return the next token from standard input
-// gettok works by calling getchar() function to read chars one at a time
-// Then it recognizes them and stores the last character read in LastChar
+// It's called to return the next token from the source buffer
+// gettok walks CurPtr over the buffer and never copies the text it reads,
+// identifiers and numbers are handed out as spans into the buffer
 int gettok()
 {
-  static int LastChar = ' ';
-
   // The first thing we need to do is ignore whitespaces between tokens
-  while (isspace(LastChar))
+  CurPtr = skipSpace(CurPtr, BufferEnd);
+
+  const char *TokStart = CurPtr;
+
+  // If the input is exhausted we are at the end of the file
+  if (CurPtr == BufferEnd)
   {
-    LastChar = getchar();
+    return formToken(TokStart, tok_eof);
   }
 
   // Next thing is recognize identifier and specific keywords like "def"
-  if (isalpha(LastChar))
+  if (isAlphaChar(*CurPtr))
   {
-    IdentifierStr = LastChar;
-
-    // Stacking together all alphanumeric characters into IdentifierStr
-    while (isalnum(LastChar = getchar()))
-    {
-      IdentifierStr += LastChar;
-    }
-
-    if (IdentifierStr == "def")
-    {
-      return tok_def;
-    }
-
-    if (IdentifierStr == "extern")
-    {
-      return tok_extern;
-    }
-
-    if (IdentifierStr == "if")
-    {
-      return tok_if;
-    }
-
-    if (IdentifierStr == "then")
-    {
-      return tok_then;
-    }
-
-    if (IdentifierStr == "else")
-    {
-      return tok_else;
-    }
-
-    if (IdentifierStr == "for")
-    {
-      return tok_for;
-    }
-
-    if (IdentifierStr == "in")
-    {
-      return tok_in;
-    }
-
-    if (IdentifierStr == "binary")
-    {
-      return tok_binary;
-    }
-
-    if (IdentifierStr == "unary")
-    {
-      return tok_unary;
-    }
-
-    if (IdentifierStr == "var")
-    {
-      return tok_var;
-    }
+    // Stretching the identifier over all alphanumeric characters
+    CurPtr = skipAlnum(CurPtr + 1, BufferEnd);
 
-    return tok_identifier;
+    IdentifierStr = llvm::StringRef(TokStart, CurPtr - TokStart);
+
+    int Tok = getKeywordToken(IdentifierStr);
+    if (Tok == tok_identifier)
+      IdentifierSym = intern(IdentifierStr);
+    return formToken(TokStart, Tok);
   }
 
-  // Stacking together only numeric values
-  if (isdigit(LastChar) || LastChar == '.')
+  // Stretching the number over numeric characters only
+  if (isNumberChar(*CurPtr))
   {
-    std::string NumStr;
+    CurPtr = skipNumber(CurPtr + 1, BufferEnd);
 
-    do
-    {
-      NumStr += LastChar;
-      LastChar = getchar();
-    } while (isdigit(LastChar) || LastChar == '.');
-
-    // Convert numeric string to numeric value
-    // that we are store in NumVal
+    // Convert numeric text to numeric value that we are store in NumVal.
+    // strtod needs a terminated string that ends exactly at the token, so
+    // the digits are copied to the stack first (numbers are short)
+    llvm::SmallString<64> NumStr(TokStart, CurPtr);
     NumVal = strtod(NumStr.c_str(), 0);
-    return tok_number;
+    return formToken(TokStart, tok_number);
   }
 
   // Handling comments by skipping to the end of the line
   // and return the next token
-  if (LastChar == '#')
+  if (*CurPtr == '#')
   {
-    do
-    {
-      LastChar = getchar();
-    } while (LastChar != EOF && LastChar != '\n' && LastChar != '\r');
-
-    if (LastChar != EOF)
-    {
-      return gettok();
-    }
-  }
+    CurPtr = skipToLineEnd(CurPtr + 1, BufferEnd);
 
-  // Finally, if the input doesn't match one of the above cases
-  // it's either an operator character like '+' or the end of the file
-  if (LastChar == EOF)
-  {
-    return tok_eof;
+    return gettok();
   }
 
-  int ThisChar = LastChar;
-  LastChar = getchar();
-  return ThisChar;
+  // Finally, if the input doesn't match one of the above cases
+  // it's an operator character like '+'
+  int ThisChar = (unsigned char)*CurPtr++;
+  return formToken(TokStart, ThisChar);
 }
 
 int getNextToken()
 {
+  countToken();
   return CurTok = gettok();
 }
@@ -1,22 +1,57 @@
 #ifndef __LEXER_H__
 #define __LEXER_H__
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "lexer/symbol.h"
+
 #include <cstdlib>
 #include <string>
 
+// The lexer works in place over the whole source text, which is read once
+// into a single buffer (files are memory mapped when that is cheaper).
+// Filename "-" reads standard input. Returns false if it cannot be read.
+// All of the lexer's state is per thread, so every thread can lex a source
+// of its own
+bool InitializeLexer(const std::string &Filename);
+
+// Reads a source the way InitializeLexer does, logging why on failure
+std::unique_ptr<llvm::MemoryBuffer> ReadSource(const std::string &Filename);
+
+// Same as above for source text that is already in memory
+void InitializeLexer(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+// Where a token sits in the source buffer
+struct TokenSpan
+{
+  size_t Offset;
+  size_t Length;
+};
+
+// Returns the source text covered by a span, without copying it
+llvm::StringRef getSpanText(TokenSpan Span);
+
 // Provide a simple token buffer
 // CurTok is the current token the parser is looking at
 // getNextToken reads another token from the lexer and updates CurTok with its results
-extern int CurTok;
+extern thread_local int CurTok;
 int gettok();
 int getNextToken();
 
+// CurTokSpan is the span of the token gettok returned last
+extern thread_local TokenSpan CurTokSpan;
+
 // If the current token is an identifier
 // IdentifierStr will hold the name of the identifier
-extern std::string IdentifierStr;
+// It points into the source buffer, so it's only valid until the next token
+extern thread_local llvm::StringRef IdentifierStr;
+
+// For identifiers IdentifierSym is the interned IdentifierStr, unlike the
+// string it stays valid until the symbol table is cleared
+extern thread_local Symbol IdentifierSym;
 
 // If the current token is a numeric literal
 // NumVal holds its value
-extern double NumVal;
+extern thread_local double NumVal;
 
 #endif
@@ -0,0 +1,126 @@
+#include "lexer/scanner.h"
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+
+// Scalar classifiers, used for the tail of the buffer and when no SIMD
+// instruction set is available. The is* functions are undefined for
+// negative chars, so widen them first
+static inline bool isSpaceChar(char C) { return isspace((unsigned char)C); }
+static inline bool isAlnumChar(char C) { return isalnum((unsigned char)C); }
+static inline bool isNumberChar(char C) { return isdigit((unsigned char)C) || C == '.'; }
+static inline bool isLineChar(char C) { return C != '\n' && C != '\r'; }
+
+#if !defined(LEXER_NO_SIMD) && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+
+// A thin layer over the vector instructions, so that the classifiers below
+// are written once for both widths
+#if defined(__AVX2__)
+typedef __m256i Vec;
+static const ptrdiff_t VecWidth = 32;
+static const uint32_t FullMask = 0xFFFFFFFFu;
+static inline Vec load(const char *P) { return _mm256_loadu_si256((const __m256i *)P); }
+static inline Vec splat(char C) { return _mm256_set1_epi8(C); }
+static inline Vec zero() { return _mm256_setzero_si256(); }
+static inline Vec orV(Vec A, Vec B) { return _mm256_or_si256(A, B); }
+static inline Vec eq(Vec A, Vec B) { return _mm256_cmpeq_epi8(A, B); }
+static inline Vec sub(Vec A, Vec B) { return _mm256_sub_epi8(A, B); }
+static inline Vec subSat(Vec A, Vec B) { return _mm256_subs_epu8(A, B); }
+static inline uint32_t toMask(Vec V) { return (uint32_t)_mm256_movemask_epi8(V); }
+const char *getScannerName() { return "avx2"; }
+#else
+typedef __m128i Vec;
+static const ptrdiff_t VecWidth = 16;
+static const uint32_t FullMask = 0xFFFFu;
+static inline Vec load(const char *P) { return _mm_loadu_si128((const __m128i *)P); }
+static inline Vec splat(char C) { return _mm_set1_epi8(C); }
+static inline Vec zero() { return _mm_setzero_si128(); }
+static inline Vec orV(Vec A, Vec B) { return _mm_or_si128(A, B); }
+static inline Vec eq(Vec A, Vec B) { return _mm_cmpeq_epi8(A, B); }
+static inline Vec sub(Vec A, Vec B) { return _mm_sub_epi8(A, B); }
+static inline Vec subSat(Vec A, Vec B) { return _mm_subs_epu8(A, B); }
+static inline uint32_t toMask(Vec V) { return (uint32_t)_mm_movemask_epi8(V); }
+const char *getScannerName() { return "sse2"; }
+#endif
+
+// Lo <= C <= Lo + Span on unsigned bytes: C - Lo wraps around below Lo, so
+// a single saturating subtract of Span leaves zero exactly inside the range
+static inline Vec inRange(Vec C, char Lo, char Span) {
+  return eq(subSat(sub(C, splat(Lo)), splat(Span)), zero());
+}
+
+static inline Vec spaceMask(Vec C) { return orV(eq(C, splat(' ')), inRange(C, '\t', 4)); }
+static inline Vec digitMask(Vec C) { return inRange(C, '0', 9); }
+// Setting bit 5 folds 'A'..'Z' onto 'a'..'z' without pulling anything else in
+static inline Vec alphaMask(Vec C) { return inRange(orV(C, splat(0x20)), 'a', 25); }
+static inline Vec alnumMask(Vec C) { return orV(alphaMask(C), digitMask(C)); }
+static inline Vec numberMask(Vec C) { return orV(digitMask(C), eq(C, splat('.'))); }
+static inline Vec lineEndMask(Vec C) { return orV(eq(C, splat('\n')), eq(C, splat('\r'))); }
+
+// Skips whole vectors while every byte is in the class, then finds the first
+// byte that is not from the mask of the vector that stopped the loop
+template <typename VecClass, typename CharClass>
+static inline const char *skipWhile(const char *Ptr, const char *End,
+                                    VecClass InVecClass, CharClass InClass) {
+  while (End - Ptr >= VecWidth) {
+    uint32_t Outside = ~toMask(InVecClass(load(Ptr))) & FullMask;
+    if (Outside)
+      return Ptr + __builtin_ctz(Outside);
+    Ptr += VecWidth;
+  }
+
+  while (Ptr != End && InClass(*Ptr))
+    ++Ptr;
+  return Ptr;
+}
+
+const char *skipSpace(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, spaceMask, isSpaceChar);
+}
+
+const char *skipAlnum(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, alnumMask, isAlnumChar);
+}
+
+const char *skipNumber(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, numberMask, isNumberChar);
+}
+
+const char *skipToLineEnd(const char *Ptr, const char *End) {
+  // The vector classifier matches line ends, so flip it to match the body
+  return skipWhile(Ptr, End,
+                   [](Vec C) { return eq(lineEndMask(C), zero()); },
+                   isLineChar);
+}
+
+#else
+
+const char *getScannerName() { return "scalar"; }
+
+template <typename CharClass>
+static inline const char *skipWhile(const char *Ptr, const char *End,
+                                    CharClass InClass) {
+  while (Ptr != End && InClass(*Ptr))
+    ++Ptr;
+  return Ptr;
+}
+
+const char *skipSpace(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, isSpaceChar);
+}
+
+const char *skipAlnum(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, isAlnumChar);
+}
+
+const char *skipNumber(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, isNumberChar);
+}
+
+const char *skipToLineEnd(const char *Ptr, const char *End) {
+  return skipWhile(Ptr, End, isLineChar);
+}
+
+#endif
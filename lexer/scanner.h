@@ -0,0 +1,26 @@
+#ifndef __SCANNER_H__
+#define __SCANNER_H__
+
+// Character-class scanners used by gettok to skip over runs of characters.
+// On x86 they classify 32 (AVX2) or 16 (SSE2) bytes per step and only fall
+// back to one byte at a time for the tail of the buffer, elsewhere (or when
+// built with -DLEXER_NO_SIMD) they are plain scalar loops.
+// Every scanner returns the first position in [Ptr, End) that is not part
+// of the run, or End.
+
+// Whitespace as isspace() sees it in the C locale: ' ', '\t' .. '\r'
+const char *skipSpace(const char *Ptr, const char *End);
+
+// Identifier characters after the first one: [0-9A-Za-z]
+const char *skipAlnum(const char *Ptr, const char *End);
+
+// Numeric literal characters: [0-9.]
+const char *skipNumber(const char *Ptr, const char *End);
+
+// Comment bodies: anything up to the next '\n' or '\r'
+const char *skipToLineEnd(const char *Ptr, const char *End);
+
+// Name of the scanner that was compiled in: "avx2", "sse2" or "scalar"
+const char *getScannerName();
+
+#endif
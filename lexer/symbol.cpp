@@ -0,0 +1,55 @@
+#include "lexer/symbol.h"
+
+#include "llvm/ADT/SmallString.h"
+
+#include <algorithm>
+#include <iterator>
+
+// Every thread starts out with a table of its own, CurrentTable points
+// elsewhere only after setSymbolTable
+static thread_local SymbolTable OwnTable;
+static thread_local SymbolTable *CurrentTable = nullptr;
+
+SymbolTable &getSymbolTable() {
+  return CurrentTable ? *CurrentTable : OwnTable;
+}
+
+void setSymbolTable(SymbolTable *Table) { CurrentTable = Table; }
+
+void SymbolTable::clear() {
+  Ids.clear();
+  Names.resize(1);
+  std::fill(std::begin(BinaryOps), std::end(BinaryOps), Symbol());
+  std::fill(std::begin(UnaryOps), std::end(UnaryOps), Symbol());
+}
+
+Symbol intern(llvm::StringRef Name) {
+  SymbolTable &Table = getSymbolTable();
+  auto Inserted = Table.Ids.try_emplace(Name, Table.Names.size());
+  if (Inserted.second)
+    Table.Names.push_back(Inserted.first->getKey());
+  return Symbol(Inserted.first->second);
+}
+
+llvm::StringRef Symbol::getName() const { return getSymbolTable().Names[Id]; }
+
+// Operator functions are looked up on every use of the operator, so their
+// symbols are cached per character instead of building the name each time
+static Symbol getOperatorSymbol(Symbol (&Cache)[256], llvm::StringRef Prefix,
+                                char Op) {
+  Symbol &S = Cache[(unsigned char)Op];
+  if (!S.isValid()) {
+    llvm::SmallString<8> Name(Prefix);
+    Name += Op;
+    S = intern(Name);
+  }
+  return S;
+}
+
+Symbol getBinaryOpSymbol(char Op) {
+  return getOperatorSymbol(getSymbolTable().BinaryOps, "binary", Op);
+}
+
+Symbol getUnaryOpSymbol(char Op) {
+  return getOperatorSymbol(getSymbolTable().UnaryOps, "unary", Op);
+}
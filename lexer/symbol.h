@@ -0,0 +1,97 @@
+#ifndef __SYMBOL_H__
+#define __SYMBOL_H__
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <vector>
+
+// Symbol - An interned identifier. The lexer interns every identifier it
+// reads, so two symbols are equal exactly when their names are and the
+// parser, the AST and codegen can compare, hash and copy names as plain
+// integers. Interned names live as long as the SymbolTable holding them.
+class Symbol {
+  // 0 is the null symbol, real symbols are numbered from 1
+  unsigned Id = 0;
+
+  explicit Symbol(unsigned Id) : Id(Id) {}
+
+  friend Symbol intern(llvm::StringRef Name);
+  friend struct llvm::DenseMapInfo<Symbol>;
+
+public:
+  Symbol() = default;
+
+  unsigned getId() const { return Id; }
+  bool isValid() const { return Id != 0; }
+
+  // The interned spelling, it stays valid as long as the symbol
+  llvm::StringRef getName() const;
+
+  bool operator==(Symbol RHS) const { return Id == RHS.Id; }
+  bool operator!=(Symbol RHS) const { return Id != RHS.Id; }
+};
+
+// SymbolTable - The names interned by one program. Every thread interns into
+// a table of its own unless it is pointed at another one with
+// setSymbolTable, so that programs compiled on different threads never
+// share symbols. Symbols of one table mean nothing to another.
+class SymbolTable {
+  // Name to symbol id, the map owns the interned characters
+  llvm::StringMap<unsigned> Ids;
+
+  // Symbol id to name, pointing at the keys of Ids (which never move).
+  // Slot 0 is the null symbol
+  std::vector<llvm::StringRef> Names;
+
+  // The symbols of the operator functions, by operator character
+  Symbol BinaryOps[256];
+  Symbol UnaryOps[256];
+
+  friend Symbol intern(llvm::StringRef Name);
+  friend Symbol getBinaryOpSymbol(char Op);
+  friend Symbol getUnaryOpSymbol(char Op);
+  friend class Symbol;
+
+public:
+  SymbolTable() : Names(1) {}
+
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+
+  // Forgets every symbol, they must not be used any more
+  void clear();
+};
+
+// The table intern and getName work on in the calling thread
+SymbolTable &getSymbolTable();
+
+// Makes the calling thread use Table, e.g. a worker that generates code for
+// an AST parsed by another thread, or the thread's own table again if Table
+// is null. Interning is not thread safe: only the thread that parses may
+// intern, other threads sharing its table may call getName on symbols that
+// already exist
+void setSymbolTable(SymbolTable *Table);
+
+// Returns the symbol for Name, interning it on first use
+Symbol intern(llvm::StringRef Name);
+
+// The symbols of the functions implementing user defined operators,
+// "binary" or "unary" followed by the operator character. They intern on
+// the first call for a character, like intern
+Symbol getBinaryOpSymbol(char Op);
+Symbol getUnaryOpSymbol(char Op);
+
+namespace llvm {
+template <> struct DenseMapInfo<Symbol> {
+  static inline Symbol getEmptyKey() { return Symbol(~0u); }
+  static inline Symbol getTombstoneKey() { return Symbol(~0u - 1); }
+  static unsigned getHashValue(Symbol S) {
+    return DenseMapInfo<unsigned>::getHashValue(S.getId());
+  }
+  static bool isEqual(Symbol LHS, Symbol RHS) { return LHS == RHS; }
+};
+} // namespace llvm
+
+#endif
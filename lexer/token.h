@@ -28,7 +28,13 @@ enum Token
   tok_unary = -12,
   
   // var definition
-  tok_var = -13
+  tok_var = -13,
+
+  // conversions
+  tok_as = -14,
+
+  // function qualifiers
+  tok_pure = -15
 };
 
 #endif
@@ -1,8 +1,18 @@
 #include "logger/logger.h"
 
+#include "llvm/Support/raw_ostream.h"
+
+thread_local llvm::raw_ostream *ErrorStream = nullptr;
+
+thread_local unsigned NumErrors = 0;
+
 // Some helpers for error handling
-std::unique_ptr<ExprAST> LogError(const char *Str) {
-  fprintf(stderr, "LogError: %s\n", Str);
+ExprAST *LogError(const char *Str) {
+  ++NumErrors;
+  if (ErrorStream)
+    *ErrorStream << "LogError: " << Str << '\n';
+  else
+    fprintf(stderr, "LogError: %s\n", Str);
   return nullptr;
 }
 
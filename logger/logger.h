@@ -4,7 +4,17 @@
 #include "ast/ExprAST.h"
 #include "ast/PrototypeAST.h"
 
-std::unique_ptr<ExprAST> LogError(const char *Str);
+namespace llvm {
+class raw_ostream;
+}
+
+// Where the calling thread's errors go, standard error while it is null
+extern thread_local llvm::raw_ostream *ErrorStream;
+
+// The number of errors logged by the calling thread so far
+extern thread_local unsigned NumErrors;
+
+ExprAST *LogError(const char *Str);
 std::unique_ptr<PrototypeAST> LogErrorP(const char *Str);
 llvm::Value *LogErrorV(const char *Str);
 
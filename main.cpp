@@ -1,125 +1,221 @@
-// lexer headers
-#include "lexer/lexer.h"
-#include "lexer/token.h"
-
-// AST headers
-#include "ast/BinaryExprAST.h"
-#include "ast/CallExprAST.h"
-#include "ast/ExprAST.h"
-#include "ast/FunctionAST.h"
-#include "ast/NumberExprAST.h"
-#include "ast/PrototypeAST.h"
-#include "ast/VariableExprAST.h"
+// compiler session headers
+#include "session/session.h"
 
-// parser headers
-#include "parser/parser.h"
+// compile server headers
+#include "server/server.h"
 
-// logger headers
-#include "logger/logger.h"
+// lexer headers
+#include "lexer/lexer.h"
 
-// kaleidoscope headers
-#include "kaleidoscope/kaleidoscope.h"
+// stats headers
+#include "stats/stats.h"
 
 // LLVM headers
-#include "llvm/ADT/APFloat.h"
-#include "llvm/ADT/STLExtras.h"
-#include "llvm/IR/BasicBlock.h"
-#include "llvm/IR/Constants.h"
-#include "llvm/IR/DerivedTypes.h"
-#include "llvm/IR/Function.h"
-#include "llvm/IR/IRBuilder.h"
-#include "llvm/IR/LLVMContext.h"
-#include "llvm/IR/Module.h"
-#include "llvm/IR/Type.h"
-#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
 // stdlib headers
-#include <algorithm>
-#include <cctype>
 #include <cstdio>
-#include <cstdlib>
-#include <map>
 #include <memory>
 #include <string>
-#include <vector>
 
 using namespace llvm;
 
-static void HandleDefinition() {
-  if (auto FnAST = ParseDefinition()) {
-    if (auto *FnIR = FnAST->codegen()) {
-      // fprintf(stderr, "Read function definition:");
-      // FnIR->print(errs());
-      // fprintf(stderr, "\n");
-    }
-  } else {
-    getNextToken();
-  }
+static cl::opt<std::string> InputFilename(cl::Positional, cl::init("-"),
+    cl::desc("<input file>"));
+
+static cl::opt<bool> UseJIT("jit",
+    cl::desc("Compile each item in-process and run top-level expressions "
+             "instead of printing the module"));
+
+static cl::opt<bool> LazyJIT("lazy-jit", cl::init(true),
+    cl::desc("With --jit, optimize and compile every function the first "
+             "time it is called instead of when it is defined (default: on)"));
+
+static cl::opt<unsigned> OptimizationLevel("O", cl::Prefix, cl::init(0),
+    cl::desc("Optimization level: -O0 (default), -O1, -O2 or -O3"));
+
+static cl::opt<EmitKind> Emit("emit", cl::init(emit_ll),
+    cl::desc("Kind of output to write"),
+    cl::values(clEnumValN(emit_ll, "ll", "Textual LLVM IR (default)"),
+               clEnumValN(emit_bc, "bc", "Binary LLVM bitcode"),
+               clEnumValN(emit_asm, "asm", "Native assembly for the host"),
+               clEnumValN(emit_obj, "obj", "Native object file for the host")));
+
+static cl::opt<std::string> OutputFilename("o", cl::init("-"),
+    cl::desc("Output filename (default: standard output)"),
+    cl::value_desc("filename"));
+
+static cl::opt<bool> TimeReport("time-report",
+    cl::desc("Time each phase of every top-level item and print a report "
+             "with token, AST node and IR counts at exit"));
+
+static cl::opt<ReportFormat> TimeReportFormat("time-report-format",
+    cl::init(report_table), cl::desc("Layout of the --time-report output"),
+    cl::values(clEnumValN(report_table, "table", "Aligned text table (default)"),
+               clEnumValN(report_json, "json", "JSON, one object per item")));
+
+static cl::opt<std::string> TimeReportFile("time-report-file", cl::init(""),
+    cl::desc("Write the --time-report output here instead of stderr"),
+    cl::value_desc("filename"));
+
+static cl::opt<unsigned> CodegenThreads("codegen-threads", cl::init(1),
+    cl::desc("Parse the whole input first, then generate and optimize its "
+             "functions on this many threads (0: one per core)"));
+
+static cl::opt<bool> SimplifyAST("simplify", cl::init(true),
+    cl::desc("Fold constants and IEEE-safe identities in the AST before "
+             "generating IR (default: on)"));
+
+static cl::opt<std::string> CacheDirectory("cache-dir", cl::init(""),
+    cl::desc("Keep the IR of every function in this directory and reuse it "
+             "while the function and what it depends on are unchanged"),
+    cl::value_desc("directory"));
+
+static cl::opt<bool> FastMath("fast-math",
+    cl::desc("Allow every relaxation of --fp-flags and flushing denormals "
+             "to zero, like -ffast-math"));
+
+enum FPFlag { fp_nnan, fp_ninf, fp_nsz, fp_arcp, fp_reassoc, fp_contract, fp_afn };
+
+static cl::bits<FPFlag> FPFlags("fp-flags", cl::CommaSeparated,
+    cl::desc("Floating point relaxations to allow, e.g. --fp-flags=nsz,contract"),
+    cl::values(clEnumValN(fp_nnan, "nnan", "Assume there are no NaNs"),
+               clEnumValN(fp_ninf, "ninf", "Assume there are no infinities"),
+               clEnumValN(fp_nsz, "nsz", "Ignore the sign of zeros"),
+               clEnumValN(fp_arcp, "arcp", "Allow reciprocals instead of divisions"),
+               clEnumValN(fp_reassoc, "reassoc", "Allow reassociation, e.g. to vectorize reductions"),
+               clEnumValN(fp_contract, "contract", "Allow fusing multiplies and adds into FMAs"),
+               clEnumValN(fp_afn, "afn", "Allow approximate math functions")));
+
+static cl::opt<bool> FlushDenormalsOption("flush-denormals",
+    cl::desc("Allow denormal floating point values to be treated as zero"));
+
+static cl::opt<bool> ReportTailCalls("report-tail-calls",
+    cl::desc("Report every recursive call that is not a tail call, and so "
+             "grows the stack on every level"));
+
+static cl::opt<std::string> ProfileGenerateOption("profile-generate",
+    cl::ValueOptional, cl::init(""),
+    cl::desc("Instrument the code to write a profile of its runs, to "
+             "default.profraw or the given file; link it with "
+             "clang -fprofile-generate"),
+    cl::value_desc("filename"));
+
+static cl::opt<std::string> ProfileUseOption("profile-use", cl::init(""),
+    cl::desc("Optimize for the runs recorded in this profile, merged with "
+             "llvm-profdata from a --profile-generate build"),
+    cl::value_desc("filename"));
+
+static cl::opt<std::string> ServeSocket("serve", cl::init(""),
+    cl::desc("Stay resident and compile the programs clients send to this "
+             "Unix socket, see client.cpp"),
+    cl::value_desc("socket"));
+
+static cl::opt<unsigned> ServeWorkers("serve-workers", cl::init(0),
+    cl::desc("Compile for up to this many clients at once under --serve "
+             "(0: one per core)"));
+
+//===----------------------------------------------------------------------===//
+// "Library" functions that can be "extern'd" from user code when running
+// with --jit.
+//===----------------------------------------------------------------------===//
+
+/// putchard - putchar that takes a double and returns 0.
+extern "C" double putchard(double X) {
+  fputc((char)X, stderr);
+  return 0;
 }
 
-static void HandleExtern() {
-  if (auto ProtoAST = ParseExtern()) {
-    if (auto *FnIR = ProtoAST->codegen()) {
-      // fprintf(stderr, "Read extern:");
-      // FnIR->print(errs());
-      // fprintf(stderr, "\n");
-    }
-  } else {
-    getNextToken();
-  }
+/// printd - printf that takes a double prints it as "%f\n", returning 0.
+extern "C" double printd(double X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
 }
 
-static void HandleTopLevelExpression() {
-  if (auto FnAST = ParseTopLevelExpr()) {
-    if (auto *FnIR = FnAST->codegen()) {
-      // fprintf(stderr, "Read top-level expression:");
-      // FnIR->print(errs());
-      // fprintf(stderr, "\n");
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Kaleidoscope compiler\n");
+  if (!ServeSocket.empty()) {
+    // Every request brings its own compile flags
+    if (UseJIT || TimeReport) {
+      fprintf(stderr, "--jit and --time-report cannot be used with --serve\n");
+      return 1;
     }
-  } else {
-    getNextToken();
+    return RunServer(ServeSocket, ServeWorkers) ? 0 : 1;
+  }
+  if (UseJIT && (Emit.getNumOccurrences() || OutputFilename.getNumOccurrences())) {
+    fprintf(stderr, "--emit and -o cannot be used with --jit\n");
+    return 1;
+  }
+  if (UseJIT && CodegenThreads.getNumOccurrences()) {
+    fprintf(stderr, "--codegen-threads cannot be used with --jit\n");
+    return 1;
+  }
+  // The profile runtime is linked into executables, not into the JIT
+  if (UseJIT && (ProfileGenerateOption.getNumOccurrences() ||
+                 ProfileUseOption.getNumOccurrences())) {
+    fprintf(stderr, "--profile-generate and --profile-use cannot be used "
+                    "with --jit\n");
+    return 1;
   }
-}
 
-static void MainLoop() {
-  while (true) {
-    // fprintf(stderr, "ready> ");
-
-    switch (CurTok) {
-      case tok_eof:
-      return;
-      case ';':
-      getNextToken();
-      break;
-      case tok_def:
-      HandleDefinition();
-      break;
-      case tok_extern:
-      HandleExtern();
-      break;
-      default:
-      HandleTopLevelExpression();
-      break;
-    }
+  CompilerOptions Options;
+  Options.OptLevel = OptimizationLevel;
+  Options.Simplify = SimplifyAST;
+  Options.FastMath.setNoNaNs(FastMath || FPFlags.isSet(fp_nnan));
+  Options.FastMath.setNoInfs(FastMath || FPFlags.isSet(fp_ninf));
+  Options.FastMath.setNoSignedZeros(FastMath || FPFlags.isSet(fp_nsz));
+  Options.FastMath.setAllowReciprocal(FastMath || FPFlags.isSet(fp_arcp));
+  Options.FastMath.setAllowReassoc(FastMath || FPFlags.isSet(fp_reassoc));
+  Options.FastMath.setAllowContract(FastMath || FPFlags.isSet(fp_contract));
+  Options.FastMath.setApproxFunc(FastMath || FPFlags.isSet(fp_afn));
+  Options.FlushDenormals = FastMath || FlushDenormalsOption;
+  Options.CodegenThreads = CodegenThreads;
+  Options.CacheDir = CacheDirectory;
+  Options.ProfileGenerate = ProfileGenerateOption.getNumOccurrences() > 0;
+  Options.ProfileGenerateFile = ProfileGenerateOption;
+  Options.ProfileUseFile = ProfileUseOption;
+  Options.ReportTailCalls = ReportTailCalls;
+  Options.LazyJIT = LazyJIT;
+
+  std::string Problem = checkOptions(Options);
+  if (!Problem.empty()) {
+    fprintf(stderr, "%s\n", Problem.c_str());
+    return 1;
   }
-}
 
-int main() {
-  BinopPrecedence['='] = 2;
-  BinopPrecedence['<'] = 10;
-  BinopPrecedence['+'] = 20;
-  BinopPrecedence['-'] = 20;
-  BinopPrecedence['*'] = 40;
+  TimeReportEnabled = TimeReport;
 
   // fprintf(stderr, "ready> ");
 
-  getNextToken();
+  auto Source = ReadSource(InputFilename);
+  if (!Source)
+    return 1;
 
-  TheModule = std::make_unique<Module>("My awesome JIT", TheContext);
-
-  MainLoop();
+  CompilerSession Session(Options);
+  if (UseJIT) {
+    if (!Session.run(std::move(Source)))
+      return 1;
+  } else if (!Session.compile(std::move(Source), Emit, OutputFilename)) {
+    return 1;
+  }
 
-  TheModule->print(outs(), nullptr);
+  if (TimeReport) {
+    if (TimeReportFile.empty()) {
+      printTimeReport(errs(), TimeReportFormat);
+    } else {
+      std::error_code EC;
+      raw_fd_ostream OS(TimeReportFile, EC, sys::fs::OF_Text);
+      if (EC) {
+        fprintf(stderr, "Could not open %s: %s\n", TimeReportFile.c_str(),
+                EC.message().c_str());
+        return 1;
+      }
+      printTimeReport(OS, TimeReportFormat);
+    }
+  }
 
-  return 0;
+  // Items with errors were left out of the output
+  return Session.getNumErrors() ? 1 : 0;
 }
@@ -0,0 +1,133 @@
+#include "optimizer/optimizer.h"
+#include "stats/stats.h"
+
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/PGOOptions.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Scalar/Reassociate.h"
+#include "llvm/Transforms/Scalar/SimplifyCFG.h"
+#include "llvm/Transforms/Utils/Mem2Reg.h"
+
+thread_local unsigned OptLevel = 0;
+
+thread_local bool ProfileGenerate = false;
+thread_local std::string ProfileGenerateFile;
+thread_local std::string ProfileUseFile;
+thread_local bool DeferOptimization = false;
+
+// The analysis managers are shared by both pipelines, their cached results
+// are dropped after every run since functions come and go between runs.
+// Pass managers cannot be shared between threads, so each thread builds
+// its own
+static thread_local llvm::LoopAnalysisManager LAM;
+static thread_local llvm::FunctionAnalysisManager FAM;
+static thread_local llvm::CGSCCAnalysisManager CGAM;
+static thread_local llvm::ModuleAnalysisManager MAM;
+
+static thread_local llvm::FunctionPassManager FPM;
+static thread_local llvm::ModulePassManager MPM;
+
+static llvm::OptimizationLevel getOptimizationLevel(unsigned Level) {
+  switch (Level) {
+  case 1:
+    return llvm::OptimizationLevel::O1;
+  case 2:
+    return llvm::OptimizationLevel::O2;
+  default:
+    return llvm::OptimizationLevel::O3;
+  }
+}
+
+// Instrumenting and reading profiles are part of the default pipelines,
+// PassBuilder adds them at the right place when given PGOOptions
+#if LLVM_VERSION_MAJOR >= 18
+static std::optional<llvm::PGOOptions> getPGOOptions() {
+#else
+static llvm::Optional<llvm::PGOOptions> getPGOOptions() {
+#endif
+  if (!ProfileGenerate && ProfileUseFile.empty())
+    return {};
+
+  auto Action = ProfileGenerate ? llvm::PGOOptions::IRInstr
+                                : llvm::PGOOptions::IRUse;
+  const std::string &File = ProfileGenerate ? ProfileGenerateFile
+                                            : ProfileUseFile;
+#if LLVM_VERSION_MAJOR >= 18
+  return llvm::PGOOptions(File, "", "", "", llvm::vfs::getRealFileSystem(),
+                          Action);
+#else
+  return llvm::PGOOptions(File, "", "", Action);
+#endif
+}
+
+void InitializeOptimizer(unsigned Level, llvm::TargetMachine *TM) {
+  OptLevel = Level;
+
+  // Start over if the thread has compiled before, the analyses registered
+  // then refer to the TargetMachine of that compilation
+  LAM = llvm::LoopAnalysisManager();
+  FAM = llvm::FunctionAnalysisManager();
+  CGAM = llvm::CGSCCAnalysisManager();
+  MAM = llvm::ModuleAnalysisManager();
+  FPM = llvm::FunctionPassManager();
+  MPM = llvm::ModulePassManager();
+
+  llvm::PassBuilder PB(TM, llvm::PipelineTuningOptions(), getPGOOptions());
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  // Without optimizations only the alwaysinline functions, i.e. the user
+  // defined operators, are inlined. The default pipelines do that too
+  if (OptLevel == 0) {
+    MPM.addPass(llvm::AlwaysInlinerPass(/*InsertLifetimeIntrinsics=*/false));
+    return;
+  }
+
+  // Promote allocas to registers.
+  FPM.addPass(llvm::PromotePass());
+  // Do simple "peephole" optimizations and bit-twiddling optzns.
+  FPM.addPass(llvm::InstCombinePass());
+  // Reassociate expressions.
+  FPM.addPass(llvm::ReassociatePass());
+  // Eliminate Common SubExpressions.
+  FPM.addPass(llvm::GVNPass());
+  // Simplify the control flow graph (deleting unreachable blocks, etc).
+  FPM.addPass(llvm::SimplifyCFGPass());
+
+  MPM = PB.buildPerModuleDefaultPipeline(getOptimizationLevel(OptLevel));
+}
+
+static void runFunctionPipeline(llvm::Function &F) {
+  if (OptLevel == 0)
+    return;
+
+  PhaseTimer Timer(phase_optimize);
+  FPM.run(F, FAM);
+  FAM.clear(F, F.getName());
+}
+
+void OptimizeFunction(llvm::Function &F) {
+  if (!DeferOptimization)
+    runFunctionPipeline(F);
+}
+
+void OptimizeModule(llvm::Module &M) {
+  // The cleanup OptimizeFunction put off comes first, as it would have
+  if (DeferOptimization)
+    for (llvm::Function &F : M)
+      if (!F.isDeclaration())
+        runFunctionPipeline(F);
+
+  PhaseTimer Timer(phase_optimize);
+  MPM.run(M, MAM);
+  MAM.clear();
+  CGAM.clear();
+  FAM.clear();
+  LAM.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef __OPTIMIZER_H__
+#define __OPTIMIZER_H__
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Target/TargetMachine.h"
+#include <string>
+
+// Optimization level picked with -O<n>, at 0 the IR is left as codegen
+// emitted it but for inlining operators
+extern thread_local unsigned OptLevel;
+
+// Profile guided optimization, set per thread before InitializeOptimizer. With
+// ProfileGenerate the module pipeline instruments the code to count how
+// often every branch is taken and every function entered; the program
+// writes the counts at exit to ProfileGenerateFile, or to the profile
+// runtime's default.profraw if it is empty. A non empty ProfileUseFile is
+// an indexed profile (.profdata) of a run of code built the same way, whose
+// counts become branch weights and function entry counts that inlining,
+// block layout and unrolling follow
+extern thread_local bool ProfileGenerate;
+extern thread_local std::string ProfileGenerateFile;
+extern thread_local std::string ProfileUseFile;
+
+// Set on a thread whose functions are optimized only once they are needed,
+// by the lazy JIT when they are first called: OptimizeFunction then leaves
+// a function as codegen emitted it and OptimizeModule runs its cleanup
+extern thread_local bool DeferOptimization;
+
+// Builds the pass pipelines for the given level, it must be called before
+// any of the functions below, on every thread that calls them, and again
+// whenever the level or the TargetMachine changes. With
+// a TargetMachine the passes can query the target's costs and features
+// (e.g. for vectorization)
+void InitializeOptimizer(unsigned Level, llvm::TargetMachine *TM = nullptr);
+
+// Runs the per-function cleanup pipeline (mem2reg, instcombine, reassociate,
+// GVN and simplifycfg) on a function that has just been generated
+void OptimizeFunction(llvm::Function &F);
+
+// Runs LLVM's default module pipeline for OptLevel, this is where inlining
+// and the loop optimizations happen. At -O0 it only inlines operators
+void OptimizeModule(llvm::Module &M);
+
+#endif
@@ -0,0 +1,224 @@
+#include "parallel/parallel.h"
+#include "cache/cache.h"
+#include "emitter/emitter.h"
+#include "kaleidoscope/fastmath.h"
+#include "kaleidoscope/kaleidoscope.h"
+#include "kaleidoscope/symboltable.h"
+#include "logger/logger.h"
+#include "optimizer/optimizer.h"
+#include "stats/stats.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// Linking has a fixed cost per module, so workers generate runs of
+// consecutive functions into one module. A few chunks per thread keep the
+// threads busy when some functions take much longer than others
+static const unsigned ChunksPerThread = 8;
+
+namespace {
+
+// What a worker hands back for one chunk. Modules cannot move between
+// contexts, so the chunk travels as bitcode and is read back into the main
+// thread's context for linking
+struct GeneratedChunk
+{
+  llvm::SmallVector<char, 0> Bitcode;
+  bool Done = false;
+};
+
+// What the workers take over from the thread that parsed the functions: the
+// symbols and prototypes the AST refers to, which they only read, the per
+// thread settings that shape the code and where errors are reported
+struct ParentState
+{
+  llvm::raw_ostream *Errors = ErrorStream;
+  SymbolTable *Symbols = &getSymbolTable();
+  PrototypeMap *Protos = FunctionProtos;
+  unsigned Level = OptLevel;
+  llvm::FastMathFlags FMF = TheFastMathFlags;
+  bool Denormals = FlushDenormals;
+  bool Generate = ProfileGenerate;
+  std::string GenerateFile = ProfileGenerateFile;
+  std::string UseFile = ProfileUseFile;
+  std::string CacheDir = getCacheDirectory();
+
+  void install() const;
+};
+
+// The work shared by the main thread and the workers
+class WorkQueue
+{
+  ParentState Parent;
+  std::vector<PendingFunction> &Functions;
+  unsigned ChunkSize;
+  std::vector<GeneratedChunk> Chunks;
+  std::atomic<unsigned> Next{0};
+
+  std::mutex Lock;
+  std::condition_variable Finished;
+
+  // Serializes the workers' writes to the parent's error stream
+  std::mutex ErrorLock;
+  std::atomic<unsigned> NumWorkerErrors{0};
+
+  void reportErrors(std::string &Errors);
+
+public:
+  WorkQueue(std::vector<PendingFunction> &Functions, unsigned NumChunks)
+      : Functions(Functions),
+        ChunkSize((Functions.size() + NumChunks - 1) / NumChunks),
+        Chunks((Functions.size() + ChunkSize - 1) / ChunkSize) {}
+
+  unsigned getNumChunks() const { return Chunks.size(); }
+  unsigned getNumErrors() const { return NumWorkerErrors; }
+
+  void runWorker();
+  GeneratedChunk &waitFor(unsigned Chunk);
+};
+
+} // namespace
+
+void ParentState::install() const {
+  setSymbolTable(Symbols);
+  FunctionProtos = Protos;
+  TheFastMathFlags = FMF;
+  FlushDenormals = Denormals;
+  ProfileGenerate = Generate;
+  ProfileGenerateFile = GenerateFile;
+  ProfileUseFile = UseFile;
+  InitializeCache(CacheDir);
+}
+
+// Passes on what a worker logged, a function's errors at a time so that
+// the lines of different workers are not mixed up
+void WorkQueue::reportErrors(std::string &Errors) {
+  {
+    std::lock_guard<std::mutex> Guard(ErrorLock);
+    if (Parent.Errors)
+      *Parent.Errors << Errors;
+    else
+      fputs(Errors.c_str(), stderr);
+  }
+  Errors.clear();
+}
+
+void WorkQueue::runWorker() {
+  // The thread_local codegen state of this thread
+  Parent.install();
+  std::string Errors;
+  llvm::raw_string_ostream ErrorOS(Errors);
+  ErrorStream = &ErrorOS;
+  NumErrors = 0;
+  TheTargetMachine = CreateTargetMachine(Parent.Level);
+  if (TheTargetMachine)
+    InitializeOptimizer(Parent.Level, TheTargetMachine.get());
+  ScopedSymbolTable NamedValues;
+
+  unsigned Chunk;
+  while ((Chunk = Next++) < Chunks.size()) {
+    GeneratedChunk &Result = Chunks[Chunk];
+
+    if (TheTargetMachine) {
+      InitializeModule();
+      SetModuleTarget(*TheModule);
+
+      unsigned Begin = Chunk * ChunkSize;
+      unsigned End = std::min<size_t>(Begin + ChunkSize, Functions.size());
+      for (unsigned Index = Begin; Index != End; ++Index) {
+        PendingFunction &F = Functions[Index];
+        resumeItem(F.ReportRow);
+
+        llvm::Function *FnIR;
+        {
+          PhaseTimer Timer(phase_codegen);
+          if (F.CacheKey.empty())
+            FnIR = F.AST->codegen(NamedValues);
+          else
+            FnIR = CodegenCached(*F.AST, F.CacheKey, NamedValues);
+        }
+        if (FnIR)
+          countIR(*FnIR);
+        ErrorOS.flush();
+        if (!Errors.empty())
+          reportErrors(Errors);
+      }
+
+      // Charged to the chunk's last function, the only row this thread may
+      // touch. Use-list order is kept so the output matches a serial run
+      PhaseTimer Timer(phase_link);
+      llvm::raw_svector_ostream OS(Result.Bitcode);
+      llvm::WriteBitcodeToFile(*TheModule, OS,
+                               /*ShouldPreserveUseListOrder=*/true);
+      TheModule.reset();
+    }
+
+    std::lock_guard<std::mutex> Guard(Lock);
+    Result.Done = true;
+    Finished.notify_all();
+  }
+
+  NumWorkerErrors += NumErrors;
+  ErrorStream = nullptr;
+}
+
+GeneratedChunk &WorkQueue::waitFor(unsigned Chunk) {
+  std::unique_lock<std::mutex> Guard(Lock);
+  Finished.wait(Guard, [&] { return Chunks[Chunk].Done; });
+  return Chunks[Chunk];
+}
+
+void GenerateInParallel(std::vector<PendingFunction> &Functions,
+                        unsigned NumThreads) {
+  if (Functions.empty())
+    return;
+
+  unsigned LinkRow = beginItem("link");
+  setItemName(TheModule->getName());
+
+  WorkQueue Queue(Functions, NumThreads * ChunksPerThread);
+  NumThreads = std::min(NumThreads, Queue.getNumChunks());
+
+  std::vector<std::thread> Workers;
+  for (unsigned i = 0; i != NumThreads; ++i)
+    Workers.emplace_back(&WorkQueue::runWorker, &Queue);
+
+  // Link in source order while the workers carry on with later chunks
+  llvm::Linker L(*TheModule);
+  for (unsigned Chunk = 0; Chunk != Queue.getNumChunks(); ++Chunk) {
+    GeneratedChunk &Result = Queue.waitFor(Chunk);
+    if (Result.Bitcode.empty())
+      continue;
+
+    resumeItem(LinkRow);
+    PhaseTimer Timer(phase_link);
+    llvm::StringRef Bitcode(Result.Bitcode.data(), Result.Bitcode.size());
+    auto M = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(Bitcode, TheModule->getModuleIdentifier()),
+        TheContext);
+    if (!M) {
+      llvm::logAllUnhandledErrors(M.takeError(), llvm::errs(), "Link error: ");
+      continue;
+    }
+    if (L.linkInModule(std::move(*M)))
+      llvm::errs() << "Link error: could not link generated functions\n";
+
+    // The bitcode is not needed any more
+    Result.Bitcode = llvm::SmallVector<char, 0>();
+  }
+
+  for (std::thread &Worker : Workers)
+    Worker.join();
+  NumErrors += Queue.getNumErrors();
+}
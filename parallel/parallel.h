@@ -0,0 +1,35 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include "ast/FunctionAST.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// A parsed function that still has to be generated
+struct PendingFunction
+{
+  std::unique_ptr<FunctionAST> AST;
+
+  // The --time-report row its codegen is charged to
+  unsigned ReportRow;
+
+  // Its key in the function cache, empty when the cache is off
+  std::string CacheKey;
+};
+
+// Generates and optimizes Functions on NumThreads worker threads and links
+// the results into TheModule in the order they are given, so the output
+// does not depend on the number of threads or their timing.
+//
+// Every worker has its own LLVMContext, module, TargetMachine and pass
+// pipelines, and shares the symbols, prototypes and settings of the calling
+// thread; their errors go to its ErrorStream and count in its NumErrors.
+// The functions must all have been declared (FunctionAST::declare)
+// and the AST arena must stay alive until this returns. Functions whose
+// codegen fails are left out, as they would be when generated one by one.
+void GenerateInParallel(std::vector<PendingFunction> &Functions,
+                        unsigned NumThreads);
+
+#endif
@@ -1,6 +1,20 @@
 #include "parser/parser.h"
+#include "stats/stats.h"
 
-std::map<char, int> BinopPrecedence;
+thread_local std::map<char, int> BinopPrecedence;
+
+// The number of top-level expressions parsed from the current input
+static thread_local unsigned NumTopLevelExprs = 0;
+
+void InitializeParser() {
+  NumTopLevelExprs = 0;
+  BinopPrecedence.clear();
+  BinopPrecedence['='] = 2;
+  BinopPrecedence['<'] = 10;
+  BinopPrecedence['+'] = 20;
+  BinopPrecedence['-'] = 20;
+  BinopPrecedence['*'] = 40;
+}
 
 static int GetTokPrecedence() {
   if (!isascii(CurTok)) {
@@ -15,14 +29,15 @@ static int GetTokPrecedence() {
 
 // This routine expects to be called when the current token is a tok_number
 // It takes the current number value and creates a NumberExprAST node
-std::unique_ptr<ExprAST> ParseNumberExpr() {
-  auto Result = std::make_unique<NumberExprAST>(NumVal);
+ExprAST *ParseNumberExpr() {
+  countASTNode(ast_number);
+  auto Result = TheASTArena.create<NumberExprAST>(NumVal);
   getNextToken();
-  return std::move(Result);
+  return Result;
 }
 
 // This routine parses expressions in "(" and ")" characters
-std::unique_ptr<ExprAST> ParseParenExpr() {
+ExprAST *ParseParenExpr() {
   getNextToken();
 
   auto V = ParseExpression();
@@ -38,22 +53,78 @@ std::unique_ptr<ExprAST> ParseParenExpr() {
   return V;
 }
 
+/// type ::= 'f64' | 'f32' | 'i64' | 'bool' | 'vec2' | 'vec4' | 'vec8' | 'vec16'
+///        |  ('f64' | 'f32' | 'i64') '[' ']'
+/// typeannotation ::= (':' type)?
+// Leaves Ty alone if there is no annotation
+static bool ParseTypeAnnotation(ValueType &Ty) {
+  if (CurTok != ':')
+    return true;
+  getNextToken(); // eat ':'.
+
+  if (CurTok != tok_identifier || !lookupType(IdentifierStr, Ty)) {
+    LogError("Expected a type after ':'");
+    return false;
+  }
+  getNextToken(); // eat the type.
+
+  if (CurTok != '[')
+    return true;
+  getNextToken(); // eat '['.
+  if (!getArrayType(Ty, Ty)) {
+    LogError("Arrays can only hold f64, f32 or i64");
+    return false;
+  }
+  if (CurTok != ']') {
+    LogError("Expected ']' in array type");
+    return false;
+  }
+  getNextToken(); // eat ']'.
+  return true;
+}
+
+/// argattributes ::= ('noalias' | 'align' number)*
+// Only array arguments take attributes, noalias and align are not keywords
+// anywhere else
+static bool ParseArgAttributes(ArgAttributes &Attrs) {
+  while (CurTok == tok_identifier) {
+    if (IdentifierStr == "noalias") {
+      Attrs.NoAlias = true;
+      getNextToken(); // eat 'noalias'.
+    } else if (IdentifierStr == "align") {
+      getNextToken(); // eat 'align'.
+      if (CurTok != tok_number || NumVal < 1 || NumVal > 4096 ||
+          !llvm::isPowerOf2_32((unsigned)NumVal) ||
+          (double)(unsigned)NumVal != NumVal) {
+        LogError("Expected a power of two up to 4096 after 'align'");
+        return false;
+      }
+      Attrs.Align = (unsigned)NumVal;
+      getNextToken(); // eat the alignment.
+    } else {
+      break;
+    }
+  }
+  return true;
+}
+
 // This routine expects to be called when current token is tok_identifier
-std::unique_ptr<ExprAST> ParseIdentifierExpr() {
-  std::string IdName = IdentifierStr;
+ExprAST *ParseIdentifierExpr() {
+  Symbol IdName = IdentifierSym;
 
   getNextToken();
 
   if (CurTok != '(') {
-    return std::make_unique<VariableExprAST>(IdName);
+    countASTNode(ast_variable);
+    return TheASTArena.create<VariableExprAST>(IdName);
   }
 
   getNextToken();
-  std::vector<std::unique_ptr<ExprAST>> Args;
+  llvm::SmallVector<ExprAST *, 8> Args;
   if (CurTok != ')') {
     while (true) {
       if (auto Arg = ParseExpression()) {
-        Args.push_back(std::move(Arg));
+        Args.push_back(Arg);
       } else {
         return nullptr;
       }
@@ -72,10 +143,12 @@ std::unique_ptr<ExprAST> ParseIdentifierExpr() {
 
   getNextToken();
 
-  return std::make_unique<CallExprAST>(IdName, std::move(Args));
+  countASTNode(ast_call);
+  return TheASTArena.create<CallExprAST>(
+      IdName, TheASTArena.copyArray(llvm::ArrayRef<ExprAST *>(Args)));
 }
 
-std::unique_ptr<ExprAST> ParsePrimary() {
+ExprAST *ParsePrimary() {
   switch (CurTok) {
     default:
     return LogError("Unknown token when expecting an expression");
@@ -91,10 +164,36 @@ std::unique_ptr<ExprAST> ParsePrimary() {
     return ParseForExpr();
     case tok_var:
     return ParseVarExpr();
+    case '[':
+    return ParseVectorExpr();
+  }
+}
+
+/// vectorexpr ::= '[' expression (',' expression)* ']'
+ExprAST *ParseVectorExpr() {
+  getNextToken(); // eat '['.
+
+  llvm::SmallVector<ExprAST *, 16> Elements;
+  while (true) {
+    auto Element = ParseExpression();
+    if (!Element)
+      return nullptr;
+    Elements.push_back(Element);
+
+    if (CurTok == ']')
+      break;
+    if (CurTok != ',')
+      return LogError("Expected ']' or ',' in vector");
+    getNextToken(); // eat ','.
   }
+  getNextToken(); // eat ']'.
+
+  countASTNode(ast_vector);
+  return TheASTArena.create<VectorExprAST>(
+      TheASTArena.copyArray(llvm::ArrayRef<ExprAST *>(Elements)));
 }
 
-std::unique_ptr<ExprAST> ParseBinOpRHS(int ExprPrec, std::unique_ptr<ExprAST> LHS) {
+ExprAST *ParseBinOpRHS(int ExprPrec, ExprAST *LHS) {
   while (true) {
     int TokPrec = GetTokPrecedence();
 
@@ -112,32 +211,34 @@ std::unique_ptr<ExprAST> ParseBinOpRHS(int ExprPrec, std::unique_ptr<ExprAST> LH
 
     int NextPrec = GetTokPrecedence();
     if (TokPrec < NextPrec) {
-      RHS = ParseBinOpRHS(TokPrec + 1, std::move(RHS));
+      RHS = ParseBinOpRHS(TokPrec + 1, RHS);
       if (!RHS) {
         return nullptr;
       }
     }
 
-    LHS = std::make_unique<BinaryExprAST>(BinOp, std::move(LHS), std::move(RHS));
+    countASTNode(ast_binary);
+    LHS = TheASTArena.create<BinaryExprAST>(BinOp, LHS, RHS);
   }
 }
 
-std::unique_ptr<ExprAST> ParseExpression() {
+ExprAST *ParseExpression() {
   auto LHS = ParseUnary();
 
   if (!LHS) {
     return nullptr;
   }
 
-  return ParseBinOpRHS(0, std::move(LHS));
+  return ParseBinOpRHS(0, LHS);
 }
 
 /// prototype
-///   ::= id '(' id* ')'
-///   ::= binary LETTER number? (id, id)
+///   ::= id '(' (id typeannotation argattributes)* ')' typeannotation
+///   ::= binary LETTER number? (id typeannotation, id typeannotation)
+///       typeannotation
 std::unique_ptr<PrototypeAST> ParsePrototype()
 {
-  std::string FnName;
+  Symbol FnName;
 
   unsigned Kind = 0; // 0 = identifier, 1 = unary, 2 = binary.
   unsigned BinaryPrecedence = 30;
@@ -147,7 +248,7 @@ std::unique_ptr<PrototypeAST> ParsePrototype()
   default:
     return LogErrorP("Expected function name in prototype");
   case tok_identifier:
-    FnName = IdentifierStr;
+    FnName = IdentifierSym;
     Kind = 0;
     getNextToken();
     break;
@@ -155,8 +256,7 @@ std::unique_ptr<PrototypeAST> ParsePrototype()
     getNextToken();
     if (!isascii(CurTok))
       return LogErrorP("Expected unary operator");
-    FnName = "unary";
-    FnName += (char)CurTok;
+    FnName = getUnaryOpSymbol((char)CurTok);
     Kind = 1;
     getNextToken();
     break;
@@ -164,8 +264,7 @@ std::unique_ptr<PrototypeAST> ParsePrototype()
     getNextToken();
     if (!isascii(CurTok))
       return LogErrorP("Expected binary operator");
-    FnName = "binary";
-    FnName += (char)CurTok;
+    FnName = getBinaryOpSymbol((char)CurTok);
     Kind = 2;
     getNextToken();
 
@@ -183,33 +282,61 @@ std::unique_ptr<PrototypeAST> ParsePrototype()
   if (CurTok != '(')
     return LogErrorP("Expected '(' in prototype");
 
-  std::vector<std::string> ArgNames;
-  while (getNextToken() == tok_identifier)
-    ArgNames.push_back(IdentifierStr);
+  std::vector<Symbol> ArgNames;
+  std::vector<ValueType> ArgTypes;
+  std::vector<ArgAttributes> ArgAttrs;
+  getNextToken(); // eat '('.
+  while (CurTok == tok_identifier) {
+    ArgNames.push_back(IdentifierSym);
+    getNextToken();
+    ArgTypes.push_back(type_f64);
+    if (!ParseTypeAnnotation(ArgTypes.back()))
+      return nullptr;
+    ArgAttrs.emplace_back();
+    if (isArray(ArgTypes.back()) && !ParseArgAttributes(ArgAttrs.back()))
+      return nullptr;
+  }
   if (CurTok != ')')
     return LogErrorP("Expected ')' in prototype");
 
   // success.
   getNextToken(); // eat ')'.
 
+  ValueType ReturnType = type_f64;
+  if (!ParseTypeAnnotation(ReturnType))
+    return nullptr;
+  if (isArray(ReturnType))
+    return LogErrorP("Functions cannot return arrays");
+
   // Verify right number of names for operator.
   if (Kind && ArgNames.size() != Kind)
     return LogErrorP("Invalid number of operands for operator");
 
+  countASTNode(ast_prototype);
   return std::make_unique<PrototypeAST>(FnName, std::move(ArgNames), Kind != 0,
-                                        BinaryPrecedence);
+                                        BinaryPrecedence, std::move(ArgTypes),
+                                        ReturnType, std::move(ArgAttrs));
 }
 
-std::unique_ptr<FunctionAST> ParseDefinition() {
+/// definition ::= 'pure'? 'def' prototype expression
+// The caller has eaten 'pure' if there is one
+std::unique_ptr<FunctionAST> ParseDefinition(bool IsPure) {
+  if (CurTok != tok_def) {
+    LogError("Expected 'def' or 'extern' after 'pure'");
+    return nullptr;
+  }
   getNextToken();
 
   auto Proto = ParsePrototype();
   if (!Proto) {
     return nullptr;
   }
+  if (IsPure)
+    Proto->setPure();
 
   if (auto E = ParseExpression()) {
-    return std::make_unique<FunctionAST>(std::move(Proto), std::move(E));
+    countASTNode(ast_function);
+    return std::make_unique<FunctionAST>(std::move(Proto), E);
   }
 
   return nullptr;
@@ -217,20 +344,35 @@ std::unique_ptr<FunctionAST> ParseDefinition() {
 
 std::unique_ptr<FunctionAST> ParseTopLevelExpr() {
   if (auto E = ParseExpression()) {
-    auto Proto = std::make_unique<PrototypeAST>("__anon_expr", std::vector<std::string>());
-    return std::make_unique<FunctionAST>(std::move(Proto), std::move(E));
+    countASTNode(ast_prototype);
+    countASTNode(ast_function);
+    // Every expression is a function of its own, __anon_expr, __anon_expr.1
+    // and so on, so that they can all end up in one module
+    std::string Name = "__anon_expr";
+    if (unsigned N = NumTopLevelExprs++)
+      Name += "." + std::to_string(N);
+    auto Proto = std::make_unique<PrototypeAST>(intern(Name),
+                                                std::vector<Symbol>());
+    // The JIT runs these as double (*)(), whatever they compute
+    return std::make_unique<FunctionAST>(
+        std::move(Proto), TheASTArena.create<CastExprAST>(type_f64, E));
   }
 
   return nullptr;
 }
 
-std::unique_ptr<PrototypeAST> ParseExtern() {
+/// external ::= 'pure'? 'extern' prototype
+// The caller has eaten 'pure' if there is one
+std::unique_ptr<PrototypeAST> ParseExtern(bool IsPure) {
   getNextToken();
-  return ParsePrototype();
+  auto Proto = ParsePrototype();
+  if (Proto && IsPure)
+    Proto->setPure();
+  return Proto;
 }
 
 /// ifexpr ::= 'if' expression 'then' expression 'else' expression
-std::unique_ptr<ExprAST> ParseIfExpr() {
+ExprAST *ParseIfExpr() {
   getNextToken();  // eat the if.
 
   // condition.
@@ -255,20 +397,25 @@ std::unique_ptr<ExprAST> ParseIfExpr() {
   if (!Else)
     return nullptr;
 
-  return std::make_unique<IfExprAST>(std::move(Cond), std::move(Then),
-                                      std::move(Else));
+  countASTNode(ast_if);
+  return TheASTArena.create<IfExprAST>(Cond, Then, Else);
 }
 
-/// forexpr ::= 'for' identifier '=' expr ',' expr (',' expr)? 'in' expression
-std::unique_ptr<ExprAST> ParseForExpr() {
+/// forexpr ::= 'for' identifier typeannotation '=' expr ',' expr (',' expr)?
+///              'in' expression
+ExprAST *ParseForExpr() {
   getNextToken();  // eat the for.
 
   if (CurTok != tok_identifier)
     return LogError("expected identifier after for");
 
-  std::string IdName = IdentifierStr;
+  Symbol IdName = IdentifierSym;
   getNextToken();  // eat identifier.
 
+  ValueType VarType = type_inferred;
+  if (!ParseTypeAnnotation(VarType))
+    return nullptr;
+
   if (CurTok != '=')
     return LogError("expected '=' after for");
   getNextToken();  // eat '='.
@@ -286,7 +433,7 @@ std::unique_ptr<ExprAST> ParseForExpr() {
     return nullptr;
 
   // The step value is optional.
-  std::unique_ptr<ExprAST> Step;
+  ExprAST *Step = nullptr;
   if (CurTok == ',') {
     getNextToken();
     Step = ParseExpression();
@@ -302,18 +449,18 @@ std::unique_ptr<ExprAST> ParseForExpr() {
   if (!Body)
     return nullptr;
 
-  return std::make_unique<ForExprAST>(IdName, std::move(Start),
-                                       std::move(End), std::move(Step),
-                                       std::move(Body));
+  countASTNode(ast_for);
+  return TheASTArena.create<ForExprAST>(IdName, VarType, Start, End, Step, Body);
 }
 
-/// varexpr ::= 'var' identifier ('=' expression)?
-//                    (',' identifier ('=' expression)?)* 'in' expression
-std::unique_ptr<ExprAST> ParseVarExpr()
+/// varexpr ::= 'var' identifier typeannotation ('=' expression)?
+//                    (',' identifier typeannotation ('=' expression)?)*
+//                    'in' expression
+ExprAST *ParseVarExpr()
 {
   getNextToken(); // eat the var.
 
-  std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> VarNames;
+  llvm::SmallVector<VarBinding, 4> VarNames;
 
   // At least one variable name is required.
   if (CurTok != tok_identifier)
@@ -321,11 +468,15 @@ std::unique_ptr<ExprAST> ParseVarExpr()
 
   while (true)
   {
-    std::string Name = IdentifierStr;
+    Symbol Name = IdentifierSym;
     getNextToken(); // eat identifier.
 
+    ValueType Ty = type_inferred;
+    if (!ParseTypeAnnotation(Ty))
+      return nullptr;
+
     // Read the optional initializer.
-    std::unique_ptr<ExprAST> Init;
+    ExprAST *Init = nullptr;
     if (CurTok == '=')
     {
       getNextToken(); // eat the '='.
@@ -335,7 +486,7 @@ std::unique_ptr<ExprAST> ParseVarExpr()
         return nullptr;
     }
 
-    VarNames.push_back(std::make_pair(Name, std::move(Init)));
+    VarNames.push_back({Name, Ty, Init});
 
     // End of var list, exit loop.
     if (CurTok != ',')
@@ -355,22 +506,58 @@ std::unique_ptr<ExprAST> ParseVarExpr()
   if (!Body)
     return nullptr;
 
-  return std::make_unique<VarExprAST>(std::move(VarNames),
-                                      std::move(Body));
+  countASTNode(ast_var);
+  return TheASTArena.create<VarExprAST>(
+      TheASTArena.copyArray(llvm::ArrayRef<VarBinding>(VarNames)), Body);
+}
+
+/// postfixexpr ::= primary ('[' expression ']' | 'as' type)*
+ExprAST *ParsePostfixExpr() {
+  auto Operand = ParsePrimary();
+  while (Operand && (CurTok == '[' || CurTok == tok_as)) {
+    if (CurTok == '[') {
+      getNextToken(); // eat '['.
+      auto Index = ParseExpression();
+      if (!Index)
+        return nullptr;
+      if (CurTok != ']')
+        return LogError("Expected ']' after index");
+      getNextToken(); // eat ']'.
+
+      countASTNode(ast_index);
+      Operand = TheASTArena.create<IndexExprAST>(Operand, Index);
+      continue;
+    }
+
+    getNextToken(); // eat 'as'.
+
+    ValueType To;
+    if (CurTok != tok_identifier || !lookupType(IdentifierStr, To))
+      return LogError("Expected a type after 'as'");
+    getNextToken(); // eat the type.
+
+    countASTNode(ast_cast);
+    Operand = TheASTArena.create<CastExprAST>(To, Operand);
+  }
+  return Operand;
 }
 
 /// unary
-///   ::= primary
+///   ::= postfixexpr
 ///   ::= '!' unary
-std::unique_ptr<ExprAST> ParseUnary() {
+ExprAST *ParseUnary() {
   // If the current token is not an operator, it must be a primary expr.
-  if (!isascii(CurTok) || CurTok == '(' || CurTok == ',')
-    return ParsePrimary();
+  if (!isascii(CurTok) || CurTok == '(' || CurTok == ',' || CurTok == '[')
+    return ParsePostfixExpr();
 
-  // If this is a unary operator, read it.
+  // If this is a unary operator, read it. Its symbol is interned here, while
+  // parsing, since codegen may run on threads that must not intern
   int Opc = CurTok;
+  getUnaryOpSymbol((char)Opc);
   getNextToken();
-  if (auto Operand = ParseUnary())
-    return std::make_unique<UnaryExprAST>(Opc, std::move(Operand));
+  if (auto Operand = ParseUnary()) {
+    countASTNode(ast_unary);
+    return TheASTArena.create<UnaryExprAST>(Opc, Operand);
+  }
   return nullptr;
 }
\ No newline at end of file
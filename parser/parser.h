@@ -2,34 +2,49 @@
 #define __PARSER_H__
 
 #include <map>
+#include "llvm/ADT/SmallVector.h"
+#include "ast/ASTArena.h"
 #include "ast/BinaryExprAST.h"
 #include "ast/UnaryExprAST.h"
 #include "ast/CallExprAST.h"
+#include "ast/CastExprAST.h"
 #include "ast/ExprAST.h"
 #include "ast/FunctionAST.h"
 #include "ast/NumberExprAST.h"
 #include "ast/PrototypeAST.h"
 #include "ast/VariableExprAST.h"
 #include "ast/IfExprAST.h"
+#include "ast/IndexExprAST.h"
+#include "ast/VectorExprAST.h"
 #include "ast/ForExprAST.h"
 #include "ast/VarExprAST.h"
 #include "lexer/lexer.h"
 #include "lexer/token.h"
 
-extern std::map<char, int> BinopPrecedence;
-std::unique_ptr<ExprAST> ParseNumberExpr();
-std::unique_ptr<ExprAST> ParseParenExpr();
-std::unique_ptr<ExprAST> ParseIdentifierExpr();
-std::unique_ptr<ExprAST> ParsePrimary();
-std::unique_ptr<ExprAST> ParseBinOpRHS(int ExprPrec, std::unique_ptr<ExprAST> LHS);
-std::unique_ptr<ExprAST> ParseExpression();
-std::unique_ptr<ExprAST> ParseIfExpr();
-std::unique_ptr<ExprAST> ParseForExpr();
-std::unique_ptr<ExprAST> ParseVarExpr();
-std::unique_ptr<ExprAST> ParseUnary();
+// The precedence of every binary operator, the parser's only state besides
+// the lexer's. It is per thread like the lexer, and grows as definitions
+// of binary operators are declared
+extern thread_local std::map<char, int> BinopPrecedence;
+
+// Resets BinopPrecedence to the builtin operators and starts naming
+// top-level expressions from __anon_expr again, for a new input
+void InitializeParser();
+
+ExprAST *ParseNumberExpr();
+ExprAST *ParseParenExpr();
+ExprAST *ParseIdentifierExpr();
+ExprAST *ParsePrimary();
+ExprAST *ParseVectorExpr();
+ExprAST *ParsePostfixExpr();
+ExprAST *ParseBinOpRHS(int ExprPrec, ExprAST *LHS);
+ExprAST *ParseExpression();
+ExprAST *ParseIfExpr();
+ExprAST *ParseForExpr();
+ExprAST *ParseVarExpr();
+ExprAST *ParseUnary();
 std::unique_ptr<PrototypeAST> ParsePrototype();
-std::unique_ptr<FunctionAST> ParseDefinition();
+std::unique_ptr<FunctionAST> ParseDefinition(bool IsPure = false);
 std::unique_ptr<FunctionAST> ParseTopLevelExpr();
-std::unique_ptr<PrototypeAST> ParseExtern();
+std::unique_ptr<PrototypeAST> ParseExtern(bool IsPure = false);
 
 #endif
@@ -0,0 +1,87 @@
+#ifndef __PROTOCOL_H__
+#define __PROTOCOL_H__
+
+// The wire format between main --serve and client over a Unix socket. Both
+// ends run on the same host, so integers go in native byte order.
+//
+// A connection carries any number of requests, one after the other, each
+// answered before the next is read:
+//
+//   request:  field  the flags, main's compile flags (e.g. -O2, --emit=obj)
+//                    separated by NUL characters
+//             field  the source
+//   response: u32    0 if the program compiled without errors, 1 if not
+//             field  the output, IR, bitcode, assembly or an object file,
+//                    empty if none was produced
+//             field  what the compiler reported, as main would on stderr
+//
+// where a field is a u32 length followed by that many bytes. Only this
+// header is shared with client, which does not link LLVM
+
+// stdlib headers
+#include <cerrno>
+#include <cstdint>
+#include <string>
+
+// POSIX headers
+#include <unistd.h>
+
+// No field may be larger than this, so that a broken peer cannot make the
+// other end allocate without limit
+static const uint32_t MaxFieldSize = 1u << 30;
+
+// Reads exactly Size bytes, false on end of file or error
+inline bool readAll(int FD, void *Data, size_t Size) {
+  char *Ptr = static_cast<char *>(Data);
+  while (Size) {
+    ssize_t N = read(FD, Ptr, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+inline bool writeAll(int FD, const void *Data, size_t Size) {
+  const char *Ptr = static_cast<const char *>(Data);
+  while (Size) {
+    ssize_t N = write(FD, Ptr, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N < 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+inline bool readU32(int FD, uint32_t &Value) {
+  return readAll(FD, &Value, sizeof(Value));
+}
+
+inline bool writeU32(int FD, uint32_t Value) {
+  return writeAll(FD, &Value, sizeof(Value));
+}
+
+inline bool readField(int FD, std::string &Field) {
+  uint32_t Size;
+  if (!readU32(FD, Size) || Size > MaxFieldSize)
+    return false;
+  Field.resize(Size);
+  return readAll(FD, &Field[0], Size);
+}
+
+inline bool writeField(int FD, const char *Data, size_t Size) {
+  return Size <= MaxFieldSize && writeU32(FD, (uint32_t)Size) &&
+         writeAll(FD, Data, Size);
+}
+
+inline bool writeField(int FD, const std::string &Field) {
+  return writeField(FD, Field.data(), Field.size());
+}
+
+#endif
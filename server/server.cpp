@@ -0,0 +1,274 @@
+#include "server/server.h"
+#include "server/protocol.h"
+#include "session/session.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Connections accepted but not yet taken up by a worker
+static std::mutex QueueMutex;
+static std::condition_variable QueueReady;
+static std::deque<int> Pending;
+
+// Reads a flag's value as main's command line would a boolean option: on
+// when given without one
+static bool parseBool(llvm::StringRef Value, bool HasValue, bool &Result) {
+  if (!HasValue || Value == "true" || Value == "1")
+    Result = true;
+  else if (Value == "false" || Value == "0")
+    Result = false;
+  else
+    return false;
+  return true;
+}
+
+static bool parseFPFlags(llvm::StringRef Value, llvm::FastMathFlags &FMF) {
+  llvm::SmallVector<llvm::StringRef, 8> Names;
+  Value.split(Names, ',', -1, /*KeepEmpty=*/false);
+  for (llvm::StringRef Name : Names) {
+    if (Name == "nnan")
+      FMF.setNoNaNs();
+    else if (Name == "ninf")
+      FMF.setNoInfs();
+    else if (Name == "nsz")
+      FMF.setNoSignedZeros();
+    else if (Name == "arcp")
+      FMF.setAllowReciprocal();
+    else if (Name == "reassoc")
+      FMF.setAllowReassoc();
+    else if (Name == "contract")
+      FMF.setAllowContract();
+    else if (Name == "afn")
+      FMF.setApproxFunc();
+    else
+      return false;
+  }
+  return true;
+}
+
+// Applies one of main's compile flags to Options and Kind. Flags with a
+// value take it after '=', like --emit=obj. Returns false if the flag is not
+// one of them or its value is not valid
+static bool applyFlag(llvm::StringRef Flag, CompilerOptions &Options,
+                      EmitKind &Kind) {
+  llvm::StringRef Name, Value;
+  std::tie(Name, Value) = Flag.ltrim('-').split('=');
+  bool HasValue = Flag.contains('=');
+
+  unsigned Number;
+  if (Name.size() > 1 && Name[0] == 'O' && !HasValue)
+    return !Name.drop_front().getAsInteger(10, Options.OptLevel);
+  if (Name == "emit") {
+    if (Value == "ll")
+      Kind = emit_ll;
+    else if (Value == "bc")
+      Kind = emit_bc;
+    else if (Value == "asm")
+      Kind = emit_asm;
+    else if (Value == "obj")
+      Kind = emit_obj;
+    else
+      return false;
+    return true;
+  }
+  if (Name == "simplify")
+    return parseBool(Value, HasValue, Options.Simplify);
+  if (Name == "fast-math") {
+    bool FastMath;
+    if (!parseBool(Value, HasValue, FastMath))
+      return false;
+    if (FastMath) {
+      Options.FastMath.setFast();
+      Options.FlushDenormals = true;
+    }
+    return true;
+  }
+  if (Name == "fp-flags")
+    return HasValue && parseFPFlags(Value, Options.FastMath);
+  if (Name == "flush-denormals") {
+    bool Flush;
+    if (!parseBool(Value, HasValue, Flush))
+      return false;
+    Options.FlushDenormals |= Flush;
+    return true;
+  }
+  if (Name == "codegen-threads") {
+    if (!HasValue || Value.getAsInteger(10, Number))
+      return false;
+    Options.CodegenThreads = Number;
+    return true;
+  }
+  if (Name == "cache-dir") {
+    Options.CacheDir = Value.str();
+    return HasValue;
+  }
+  if (Name == "report-tail-calls")
+    return parseBool(Value, HasValue, Options.ReportTailCalls);
+  if (Name == "profile-generate") {
+    Options.ProfileGenerate = true;
+    Options.ProfileGenerateFile = Value.str();
+    return true;
+  }
+  if (Name == "profile-use") {
+    Options.ProfileUseFile = Value.str();
+    return HasValue && !Value.empty();
+  }
+  return false;
+}
+
+// Compiles one request, what main would print on stderr goes to Errors
+static bool compileRequest(const std::string &Flags, const std::string &Source,
+                           std::string &Output, std::string &Errors) {
+  llvm::raw_string_ostream ErrorOS(Errors);
+
+  CompilerOptions Options;
+  EmitKind Kind = emit_ll;
+  llvm::SmallVector<llvm::StringRef, 8> Args;
+  llvm::StringRef(Flags).split(Args, '\0', -1, /*KeepEmpty=*/false);
+  for (llvm::StringRef Arg : Args) {
+    if (!applyFlag(Arg, Options, Kind)) {
+      ErrorOS << "Unknown or invalid flag for --serve: " << Arg << "\n";
+      return false;
+    }
+  }
+  std::string Problem = checkOptions(Options);
+  if (!Problem.empty()) {
+    ErrorOS << Problem << "\n";
+    return false;
+  }
+
+  CompilerSession Session(Options);
+  Session.setErrorStream(ErrorOS);
+
+  llvm::SmallVector<char, 0> Buffer;
+  llvm::raw_svector_ostream OS(Buffer);
+  bool Ok = Session.compile(
+      llvm::MemoryBuffer::getMemBuffer(Source, "<request>"), Kind, OS);
+  Output.assign(Buffer.begin(), Buffer.end());
+  // Like main, fail when items were left out for their errors
+  return Ok && !Session.getNumErrors();
+}
+
+// Answers the requests of one client until it hangs up
+static void serveConnection(int FD) {
+  std::string Flags, Source;
+  while (readField(FD, Flags) && readField(FD, Source)) {
+    std::string Output, Errors;
+    bool Ok = compileRequest(Flags, Source, Output, Errors);
+    if (!writeU32(FD, Ok ? 0 : 1) || !writeField(FD, Output) ||
+        !writeField(FD, Errors))
+      break;
+  }
+  close(FD);
+}
+
+static void runWorker() {
+  // Set up the thread's context and backend before the first client waits
+  // for them
+  {
+    CompilerSession Session{CompilerOptions()};
+    Session.compile(llvm::MemoryBuffer::getMemBuffer("", "<warm up>"));
+  }
+
+  while (true) {
+    int FD;
+    {
+      std::unique_lock<std::mutex> Lock(QueueMutex);
+      QueueReady.wait(Lock, [] { return !Pending.empty(); });
+      FD = Pending.front();
+      Pending.pop_front();
+    }
+    serveConnection(FD);
+  }
+}
+
+// Binds a listening socket to Path, -1 after reporting why it cannot
+static int listenOn(const std::string &Path) {
+  sockaddr_un Addr;
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Addr.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", Path.c_str());
+    return -1;
+  }
+  memcpy(Addr.sun_path, Path.c_str(), Path.size());
+
+  struct stat Status;
+  if (lstat(Path.c_str(), &Status) == 0) {
+    if (!S_ISSOCK(Status.st_mode)) {
+      fprintf(stderr, "Not a socket: %s\n", Path.c_str());
+      return -1;
+    }
+    // Only a socket nobody answers on is left over
+    int Probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool Live = Probe >= 0 &&
+                connect(Probe, (sockaddr *)&Addr, sizeof(Addr)) == 0;
+    if (Probe >= 0)
+      close(Probe);
+    if (Live) {
+      fprintf(stderr, "A server is already listening on %s\n", Path.c_str());
+      return -1;
+    }
+    unlink(Path.c_str());
+  }
+
+  int FD = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0 || bind(FD, (sockaddr *)&Addr, sizeof(Addr)) != 0 ||
+      listen(FD, SOMAXCONN) != 0) {
+    fprintf(stderr, "Cannot listen on %s: %s\n", Path.c_str(), strerror(errno));
+    if (FD >= 0)
+      close(FD);
+    return -1;
+  }
+  return FD;
+}
+
+bool RunServer(const std::string &SocketPath, unsigned NumWorkers) {
+  // A client that hangs up early must not take the server down with it
+  signal(SIGPIPE, SIG_IGN);
+
+  int ListenFD = listenOn(SocketPath);
+  if (ListenFD < 0)
+    return false;
+
+  if (NumWorkers == 0)
+    NumWorkers = llvm::heavyweight_hardware_concurrency().compute_thread_count();
+  for (unsigned I = 0; I != NumWorkers; ++I)
+    std::thread(runWorker).detach();
+  fprintf(stderr, "Serving %s with %u workers\n", SocketPath.c_str(),
+          NumWorkers);
+
+  while (true) {
+    int FD = accept(ListenFD, nullptr, nullptr);
+    if (FD < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      fprintf(stderr, "Cannot accept on %s: %s\n", SocketPath.c_str(),
+              strerror(errno));
+      close(ListenFD);
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> Lock(QueueMutex);
+      Pending.push_back(FD);
+    }
+    QueueReady.notify_one();
+  }
+}
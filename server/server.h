@@ -0,0 +1,26 @@
+#ifndef __SERVER_H__
+#define __SERVER_H__
+
+#include <string>
+
+// main --serve: stays resident and compiles the programs that clients send
+// to the Unix socket SocketPath (see server/protocol.h and client.cpp), so
+// that they do not pay for starting the process and setting LLVM up.
+//
+// Every request carries its own compile flags and is compiled by a
+// CompilerSession on one of NumWorkers threads (0: one per core), each of
+// which keeps its LLVMContext and backend from one request to the next. A
+// connection keeps its worker until the client hangs up, so NumWorkers is
+// the number of clients served at once; more wait in line. The context
+// keeps the types, constants and names of every program it has compiled,
+// so a worker's memory grows slowly with the variety of what it is sent,
+// by about 10 MB over a few thousand requests; only restarting the server
+// gives it back. Paths in the flags are taken as they come, client.cpp
+// makes relative ones absolute.
+//
+// Runs until the process is killed, returns false if it cannot listen on
+// SocketPath. A socket left behind by a server that was killed is replaced,
+// one that a server still listens on is not
+bool RunServer(const std::string &SocketPath, unsigned NumWorkers);
+
+#endif
@@ -0,0 +1,402 @@
+#include "session/session.h"
+#include "ast/ASTArena.h"
+#include "cache/cache.h"
+#include "jit/jit.h"
+#include "kaleidoscope/fastmath.h"
+#include "kaleidoscope/symboltable.h"
+#include "lexer/lexer.h"
+#include "lexer/token.h"
+#include "logger/logger.h"
+#include "optimizer/optimizer.h"
+#include "parallel/parallel.h"
+#include "parser/parser.h"
+#include "stats/stats.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Threading.h"
+
+std::string checkOptions(const CompilerOptions &Options) {
+  if (Options.OptLevel > 3)
+    return "Invalid optimization level: -O" + std::to_string(Options.OptLevel);
+  bool UseProfile = !Options.ProfileUseFile.empty();
+  if (Options.ProfileGenerate || UseProfile) {
+    // A profile only matches code built with the same pipeline
+    if (Options.OptLevel == 0)
+      return "--profile-generate and --profile-use need -O1 or higher";
+    if (Options.ProfileGenerate && UseProfile)
+      return "--profile-generate and --profile-use cannot be used together";
+    if (UseProfile && !llvm::sys::fs::exists(Options.ProfileUseFile))
+      return "Profile not found: " + Options.ProfileUseFile;
+  }
+  return std::string();
+}
+
+CompilerSession::CompilerSession(const CompilerOptions &Options)
+    : Options(Options) {}
+
+llvm::raw_ostream &CompilerSession::getErrorStream() {
+  return Errors ? *Errors : llvm::errs();
+}
+
+// Points the calling thread's compiler state at this session and resets it
+// for a new program. Returns false if the compiler cannot be set up
+bool CompilerSession::begin(std::unique_ptr<llvm::MemoryBuffer> Source) {
+  Symbols.clear();
+  Protos.clear();
+  setSymbolTable(&Symbols);
+  SavedProtos = FunctionProtos;
+  FunctionProtos = &Protos;
+
+  ErrorStream = Errors;
+  ::NumErrors = 0;
+
+  // Read by codegen and by the target machine, which is created below
+  TheFastMathFlags = Options.FastMath;
+  FlushDenormals = Options.FlushDenormals;
+  ProfileGenerate = Options.ProfileGenerate;
+  ProfileGenerateFile = Options.ProfileGenerateFile;
+  ProfileUseFile = Options.ProfileUseFile;
+  DeferOptimization = false;
+
+  if (!InitializeTargetMachine(Options.OptLevel) ||
+      !InitializeCache(Options.CacheDir))
+    return false;
+  InitializeOptimizer(Options.OptLevel, TheTargetMachine.get());
+  InitializeModule();
+  SetModuleTarget(*TheModule);
+
+  InitializeParser();
+  TheASTArena.reset();
+  InitializeLexer(std::move(Source));
+  getNextToken();
+  return true;
+}
+
+// Gives the calling thread its own symbols and prototypes back
+void CompilerSession::end() {
+  NumErrors = ::NumErrors;
+  ErrorStream = nullptr;
+  DeferOptimization = false;
+  FunctionProtos = SavedProtos;
+  setSymbolTable(nullptr);
+}
+
+// Once the whole input is in one module, calls to operators are all in it
+// and get inlined (see PrototypeAST::codegen), so their definitions need
+// not be kept. The JIT links items by name and keeps them
+static void InternalizeOperators(llvm::Module &M) {
+  for (llvm::Function &F : M)
+    if (!F.isDeclaration() && F.hasFnAttribute(llvm::Attribute::AlwaysInline))
+      F.setLinkage(llvm::GlobalValue::InternalLinkage);
+}
+
+void CompilerSession::finishModule() {
+  beginItem("module");
+  setItemName(TheModule->getName());
+  InternalizeOperators(*TheModule);
+  OptimizeModule(*TheModule);
+}
+
+// Runs once an item has been type checked, folding keeps every type
+void CompilerSession::simplifyItem(FunctionAST &FnAST) {
+  if (!Options.Simplify)
+    return;
+  PhaseTimer Timer(phase_simplify);
+  FnAST.simplify();
+}
+
+// Runs before an item is hashed or generated, false on a type error
+bool CompilerSession::typeCheckItem(FunctionAST &FnAST) {
+  {
+    PhaseTimer Timer(phase_typecheck);
+    if (!FnAST.typeCheck(Scope))
+      return false;
+  }
+  simplifyItem(FnAST);
+
+  // The recursive calls are known once the whole body has been checked
+  if (Options.ReportTailCalls) {
+    const auto &Calls = Scope.getRecursiveCalls();
+    for (unsigned I = 0, E = Calls.size(); I != E; ++I)
+      if (!Calls[I]->isTailCall())
+        getErrorStream() << FnAST.getName().getName() << ": recursive call "
+                         << I + 1 << " of " << E << " is not a tail call\n";
+  }
+  return true;
+}
+
+void CompilerSession::handleDefinition(ScopedSymbolTable &NamedValues,
+                                       bool IsPure) {
+  beginItem("def");
+
+  std::unique_ptr<FunctionAST> FnAST;
+  {
+    PhaseTimer Timer(phase_parse);
+    FnAST = ParseDefinition(IsPure);
+    if (!FnAST)
+      getNextToken();
+  }
+
+  if (FnAST && typeCheckItem(*FnAST)) {
+    llvm::Function *FnIR;
+    {
+      PhaseTimer Timer(phase_codegen);
+      if (isCacheEnabled())
+        FnIR = CodegenCached(*FnAST, getCacheKey(*FnAST), NamedValues);
+      else
+        FnIR = FnAST->codegen(NamedValues);
+    }
+    if (FnIR) {
+      // fprintf(stderr, "Read function definition:");
+      // FnIR->print(errs());
+      // fprintf(stderr, "\n");
+      setItemName(FnIR->getName());
+      countIR(*FnIR);
+      if (UseJIT) {
+        PhaseTimer Timer(phase_jit);
+        AddModuleToJIT();
+      }
+    }
+  }
+
+  // Nothing refers to the parsed tree once it has been generated
+  TheASTArena.reset();
+}
+
+void CompilerSession::handleExtern(bool IsPure) {
+  beginItem("extern");
+
+  std::unique_ptr<PrototypeAST> ProtoAST;
+  {
+    PhaseTimer Timer(phase_parse);
+    ProtoAST = ParseExtern(IsPure);
+    if (!ProtoAST)
+      getNextToken();
+  }
+
+  if (ProtoAST) {
+    setItemName(ProtoAST->getName().getName());
+
+    llvm::Function *FnIR;
+    {
+      PhaseTimer Timer(phase_codegen);
+      FnIR = ProtoAST->codegen();
+    }
+    if (FnIR) {
+      // fprintf(stderr, "Read extern:");
+      // FnIR->print(errs());
+      // fprintf(stderr, "\n");
+
+      // Keep the prototype so that later modules can redeclare it
+      (*FunctionProtos)[ProtoAST->getName()] = std::move(ProtoAST);
+    }
+  }
+}
+
+void CompilerSession::handleTopLevelExpression(ScopedSymbolTable &NamedValues) {
+  beginItem("expr");
+
+  std::unique_ptr<FunctionAST> FnAST;
+  {
+    PhaseTimer Timer(phase_parse);
+    FnAST = ParseTopLevelExpr();
+    if (!FnAST)
+      getNextToken();
+  }
+
+  if (FnAST && typeCheckItem(*FnAST)) {
+    llvm::Function *FnIR;
+    {
+      PhaseTimer Timer(phase_codegen);
+      FnIR = FnAST->codegen(NamedValues);
+    }
+    if (FnIR) {
+      // fprintf(stderr, "Read top-level expression:");
+      // FnIR->print(errs());
+      // fprintf(stderr, "\n");
+      setItemName(FnIR->getName());
+      countIR(*FnIR);
+      if (UseJIT) {
+        PhaseTimer Timer(phase_jit);
+        fprintf(stderr, "Evaluated to %f\n", RunTopLevelExpr(FnIR->getName()));
+      }
+    }
+  }
+
+  TheASTArena.reset();
+}
+
+void CompilerSession::handleItems(ScopedSymbolTable &NamedValues) {
+  while (true) {
+    // fprintf(stderr, "ready> ");
+
+    switch (CurTok) {
+      case tok_eof:
+      return;
+      case ';':
+      getNextToken();
+      break;
+      case tok_def:
+      handleDefinition(NamedValues, /*IsPure=*/false);
+      break;
+      case tok_extern:
+      handleExtern(/*IsPure=*/false);
+      break;
+      case tok_pure:
+      // Qualifies the def or extern that follows
+      getNextToken();
+      if (CurTok == tok_extern)
+        handleExtern(/*IsPure=*/true);
+      else
+        handleDefinition(NamedValues, /*IsPure=*/true);
+      break;
+      default:
+      handleTopLevelExpression(NamedValues);
+      break;
+    }
+  }
+}
+
+// Parses the whole input for GenerateInParallel. Functions are declared as
+// soon as they are parsed, so that later items can use the operators they
+// define, and any item may call any function of the input
+void CompilerSession::parseAllItems(std::vector<PendingFunction> &Functions) {
+  llvm::DenseSet<Symbol> Defined;
+
+  while (CurTok != tok_eof) {
+    switch (CurTok) {
+      case ';':
+      getNextToken();
+      break;
+      case tok_extern:
+      handleExtern(/*IsPure=*/false);
+      break;
+      default: {
+        // 'pure' qualifies the def or extern that follows
+        bool IsPure = CurTok == tok_pure;
+        if (IsPure)
+          getNextToken();
+        if (IsPure && CurTok == tok_extern) {
+          handleExtern(/*IsPure=*/true);
+          break;
+        }
+
+        bool IsDefinition = IsPure || CurTok == tok_def;
+        unsigned Row = beginItem(IsDefinition ? "def" : "expr");
+
+        std::unique_ptr<FunctionAST> FnAST;
+        {
+          PhaseTimer Timer(phase_parse);
+          FnAST = IsDefinition ? ParseDefinition(IsPure) : ParseTopLevelExpr();
+          if (!FnAST)
+            getNextToken();
+        }
+        if (!FnAST)
+          break;
+
+        // All definitions end up in one module, so a name can only be used once
+        setItemName(FnAST->getName().getName());
+        if (!Defined.insert(FnAST->getName()).second) {
+          std::string Msg = "Redefinition of " + FnAST->getName().getName().str();
+          LogError(Msg.c_str());
+          break;
+        }
+
+        FnAST->declare();
+        Functions.push_back({std::move(FnAST), Row, std::string()});
+        break;
+      }
+    }
+  }
+
+  // Types are checked and keys taken once everything is declared, so that
+  // calls to functions further down see their prototypes
+  llvm::erase_if(Functions, [this](PendingFunction &F) {
+    resumeItem(F.ReportRow);
+    return !typeCheckItem(*F.AST);
+  });
+
+  if (isCacheEnabled()) {
+    for (PendingFunction &F : Functions) {
+      resumeItem(F.ReportRow);
+      PhaseTimer Timer(phase_cache);
+      F.CacheKey = getCacheKey(*F.AST);
+    }
+  }
+}
+
+// Generates the whole input into TheModule, one item after the other or on
+// worker threads
+void CompilerSession::generateAllItems() {
+  if (Options.CodegenThreads != 1) {
+    unsigned NumThreads = Options.CodegenThreads;
+    if (NumThreads == 0)
+      NumThreads = llvm::heavyweight_hardware_concurrency().compute_thread_count();
+
+    std::vector<PendingFunction> Functions;
+    parseAllItems(Functions);
+    GenerateInParallel(Functions, NumThreads);
+
+    Functions.clear();
+    TheASTArena.reset();
+  } else {
+    // Keeps track of which values are defined in the current scope
+    ScopedSymbolTable NamedValues;
+    handleItems(NamedValues);
+  }
+}
+
+llvm::orc::ThreadSafeModule
+CompilerSession::compile(std::unique_ptr<llvm::MemoryBuffer> Source) {
+  // Modules handed out earlier share the thread's context
+  auto Lock = TheTSContext.getLock();
+
+  llvm::orc::ThreadSafeModule Result;
+  if (begin(std::move(Source))) {
+    generateAllItems();
+    finishModule();
+    Result = llvm::orc::ThreadSafeModule(std::move(TheModule), TheTSContext);
+  }
+  end();
+  return Result;
+}
+
+bool CompilerSession::compile(std::unique_ptr<llvm::MemoryBuffer> Source,
+                              EmitKind Kind, llvm::raw_pwrite_stream &Dest) {
+  auto TSM = compile(std::move(Source));
+  if (!TSM)
+    return false;
+
+  PhaseTimer Timer(phase_emit);
+  return TSM.withModuleDo(
+      [&](llvm::Module &M) { return EmitModule(M, Kind, Dest); });
+}
+
+bool CompilerSession::compile(std::unique_ptr<llvm::MemoryBuffer> Source,
+                              EmitKind Kind, const std::string &Filename) {
+  auto TSM = compile(std::move(Source));
+  if (!TSM)
+    return false;
+
+  PhaseTimer Timer(phase_emit);
+  return TSM.withModuleDo(
+      [&](llvm::Module &M) { return EmitModule(M, Kind, Filename); });
+}
+
+bool CompilerSession::run(std::unique_ptr<llvm::MemoryBuffer> Source) {
+  bool Started = begin(std::move(Source));
+  if (Started) {
+    InitializeJIT(Options.LazyJIT);
+    // Functions that are never called are never optimized either. The cache
+    // holds optimized functions, so with it they are cleaned up right away
+    DeferOptimization = Options.LazyJIT && !isCacheEnabled();
+    UseJIT = true;
+    ScopedSymbolTable NamedValues;
+    handleItems(NamedValues);
+    UseJIT = false;
+  }
+  end();
+  return Started;
+}
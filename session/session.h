@@ -0,0 +1,140 @@
+#ifndef __SESSION_H__
+#define __SESSION_H__
+
+#include "ast/FunctionAST.h"
+#include "ast/TypeScope.h"
+#include "emitter/emitter.h"
+#include "kaleidoscope/kaleidoscope.h"
+#include "kaleidoscope/symboltable.h"
+#include "lexer/symbol.h"
+
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct PendingFunction;
+
+// The settings of a compilation, main fills them in from its command line
+struct CompilerOptions
+{
+  // -O<n>, 0 to 3
+  unsigned OptLevel = 0;
+
+  // Fold constants and IEEE-safe identities in the AST before generating IR
+  bool Simplify = true;
+
+  // The floating point relaxations of --fast-math, --fp-flags and
+  // --flush-denormals
+  llvm::FastMathFlags FastMath;
+  bool FlushDenormals = false;
+
+  // With more than one thread (0: one per core) the whole input is parsed
+  // first and its functions are generated in parallel
+  unsigned CodegenThreads = 1;
+
+  // The function cache, off while empty
+  std::string CacheDir;
+
+  // Profile guided optimization, see optimizer/optimizer.h. Both need an
+  // OptLevel of at least 1
+  bool ProfileGenerate = false;
+  std::string ProfileGenerateFile;
+  std::string ProfileUseFile;
+
+  // Report every recursive call that is not a tail call
+  bool ReportTailCalls = false;
+
+  // With run, optimize and compile every function the first time it is
+  // called rather than when it is defined, see InitializeJIT
+  bool LazyJIT = true;
+};
+
+// Returns why a compilation cannot use Options, e.g. an -O level above 3 or
+// a profile that does not exist, or an empty string if it can
+std::string checkOptions(const CompilerOptions &Options);
+
+// CompilerSession - Compiles programs with everything that used to be
+// global to the process: the interned symbols, the declared prototypes and
+// the type checker's scope belong to the session, and the lexer, parser,
+// AST arena, LLVM context, target machine and pass pipelines it drives are
+// those of the calling thread (they are thread_local). Sessions on
+// different threads thus compile at the same time without sharing
+// anything; a session must only be used by one thread at a time.
+//
+// Every compilation starts from scratch, a program cannot see what an
+// earlier one declared. Errors in an item are reported and the item is left
+// out, like main does, so the result may be partial: check getNumErrors.
+class CompilerSession
+{
+  CompilerOptions Options;
+  SymbolTable Symbols;
+  PrototypeMap Protos;
+  TypeScope Scope;
+
+  // Where errors go, standard error while null
+  llvm::raw_ostream *Errors = nullptr;
+  unsigned NumErrors = 0;
+
+  // Set while run hands the items to TheJIT
+  bool UseJIT = false;
+
+  // The FunctionProtos of the calling thread while the session is not
+  // compiling on it
+  PrototypeMap *SavedProtos = nullptr;
+
+  bool begin(std::unique_ptr<llvm::MemoryBuffer> Source);
+  void end();
+  void finishModule();
+
+  llvm::raw_ostream &getErrorStream();
+  void simplifyItem(FunctionAST &FnAST);
+  bool typeCheckItem(FunctionAST &FnAST);
+  void handleDefinition(ScopedSymbolTable &NamedValues, bool IsPure);
+  void handleExtern(bool IsPure);
+  void handleTopLevelExpression(ScopedSymbolTable &NamedValues);
+  void handleItems(ScopedSymbolTable &NamedValues);
+  void parseAllItems(std::vector<PendingFunction> &Functions);
+  void generateAllItems();
+
+public:
+  explicit CompilerSession(const CompilerOptions &Options);
+
+  CompilerSession(const CompilerSession &) = delete;
+  CompilerSession &operator=(const CompilerSession &) = delete;
+
+  const CompilerOptions &getOptions() const { return Options; }
+
+  // Sends the errors of later compilations to OS instead of standard error
+  void setErrorStream(llvm::raw_ostream &OS) { Errors = &OS; }
+
+  // Compiles Source into a module and runs the module pipeline on it. The
+  // module belongs to the calling thread's LLVMContext, which the
+  // ThreadSafeModule keeps alive; other threads must go through its lock
+  // (withModuleDo). Returns an empty module if the compiler could not be
+  // set up, e.g. for an unusable cache directory
+  llvm::orc::ThreadSafeModule compile(std::unique_ptr<llvm::MemoryBuffer> Source);
+
+  // Compiles Source and writes the module to Dest, or to Filename ("-" for
+  // stdout), in the form Kind. Returns false if it could not be written
+  bool compile(std::unique_ptr<llvm::MemoryBuffer> Source, EmitKind Kind,
+               llvm::raw_pwrite_stream &Dest);
+  bool compile(std::unique_ptr<llvm::MemoryBuffer> Source, EmitKind Kind,
+               const std::string &Filename);
+
+  // Compiles the items of Source one by one into TheJIT, creating it on the
+  // first call, and runs the top-level expressions as they come, printing
+  // their values to standard error. The JIT is shared by the process and
+  // keeps what it was given, so only one session may run programs, and a
+  // later run must not define the same names again
+  bool run(std::unique_ptr<llvm::MemoryBuffer> Source);
+
+  // The number of errors reported by the last compile or run
+  unsigned getNumErrors() const { return NumErrors; }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "stats/stats.h"
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+bool TimeReportEnabled = false;
+
+thread_local unsigned long NumTokens = 0;
+thread_local unsigned long NumASTNodes[num_ast_kinds];
+
+std::atomic<unsigned long> NumCacheHits{0};
+std::atomic<unsigned long> NumCacheMisses{0};
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+// One row of the report
+struct ItemStats
+{
+  const char *Kind;
+  std::string Name;
+  double Seconds[num_phases] = {};
+
+  // Counter values when the item began, turned into deltas once it ends
+  unsigned long Tokens;
+  unsigned long ASTNodes;
+
+  unsigned long Instructions = 0;
+  unsigned long Blocks = 0;
+};
+
+} // namespace
+
+static const char *const PhaseNames[num_phases] = {
+    "parse", "typecheck", "simplify", "codegen", "verify",
+    "optimize", "jit",      "link",      "cache",   "emit"};
+
+static const char *const ASTNodeNames[num_ast_kinds] = {
+    "number", "variable", "unary", "binary", "call", "cast", "vector", "index",
+    "if", "for", "var", "prototype", "function"};
+
+static std::vector<ItemStats> Items;
+
+// Each thread charges its time to a row of its own, NoRow before the first
+static const unsigned NoRow = ~0u;
+static thread_local unsigned CurrentRow = NoRow;
+
+// The phase being timed, or num_phases, and when it was last charged
+static thread_local Phase ActivePhase = num_phases;
+static thread_local Clock::time_point ActiveSince;
+
+static unsigned long totalASTNodes() {
+  unsigned long Total = 0;
+  for (unsigned long N : NumASTNodes)
+    Total += N;
+  return Total;
+}
+
+// Charges the time since the last call to the active phase
+static void chargeActivePhase() {
+  Clock::time_point Now = Clock::now();
+  if (ActivePhase != num_phases && CurrentRow != NoRow)
+    Items[CurrentRow].Seconds[ActivePhase] +=
+        std::chrono::duration<double>(Now - ActiveSince).count();
+  ActiveSince = Now;
+}
+
+// Turns the counter snapshots of the last row into deltas
+static void endItem() {
+  if (Items.empty())
+    return;
+  ItemStats &Item = Items.back();
+  Item.Tokens = NumTokens - Item.Tokens;
+  Item.ASTNodes = totalASTNodes() - Item.ASTNodes;
+}
+
+unsigned beginItem(const char *Kind) {
+  if (!TimeReportEnabled)
+    return NoRow;
+
+  chargeActivePhase();
+  endItem();
+
+  Items.emplace_back();
+  Items.back().Kind = Kind;
+  Items.back().Tokens = NumTokens;
+  Items.back().ASTNodes = totalASTNodes();
+  return CurrentRow = Items.size() - 1;
+}
+
+void resumeItem(unsigned Row) {
+  if (!TimeReportEnabled)
+    return;
+  chargeActivePhase();
+  CurrentRow = Row;
+}
+
+void setItemName(llvm::StringRef Name) {
+  if (TimeReportEnabled && CurrentRow != NoRow)
+    Items[CurrentRow].Name = Name.str();
+}
+
+void countIR(const llvm::Function &F) {
+  if (!TimeReportEnabled || CurrentRow == NoRow)
+    return;
+  Items[CurrentRow].Blocks += F.size();
+  Items[CurrentRow].Instructions += F.getInstructionCount();
+}
+
+PhaseTimer::PhaseTimer(Phase P) : Outer(ActivePhase) {
+  if (!TimeReportEnabled)
+    return;
+  chargeActivePhase();
+  ActivePhase = P;
+}
+
+PhaseTimer::~PhaseTimer() {
+  if (!TimeReportEnabled)
+    return;
+  chargeActivePhase();
+  ActivePhase = Outer;
+}
+
+static double itemSeconds(const ItemStats &Item) {
+  double Total = 0;
+  for (double S : Item.Seconds)
+    Total += S;
+  return Total;
+}
+
+static void printTable(llvm::raw_ostream &OS, const ItemStats &Total) {
+  OS << "===" << std::string(74, '-') << "===\n"
+     << "  Kaleidoscope time report (ms)\n"
+     << "===" << std::string(74, '-') << "===\n";
+
+  OS << llvm::left_justify("kind", 7) << ' ' << llvm::left_justify("name", 16);
+  for (const char *Name : PhaseNames)
+    OS << ' ' << llvm::right_justify(Name, 9);
+  OS << ' ' << llvm::right_justify("total", 9);
+  for (const char *Name : {"tokens", "nodes", "insts", "blocks"})
+    OS << ' ' << llvm::right_justify(Name, 8);
+  OS << '\n';
+
+  auto PrintRow = [&](const ItemStats &Item) {
+    OS << llvm::format("%-7s %-16s", Item.Kind, Item.Name.c_str());
+    for (double S : Item.Seconds)
+      OS << llvm::format(" %9.3f", S * 1000);
+    OS << llvm::format(" %9.3f %8lu %8lu %8lu %8lu\n", itemSeconds(Item) * 1000,
+                       Item.Tokens, Item.ASTNodes, Item.Instructions,
+                       Item.Blocks);
+  };
+  for (const ItemStats &Item : Items)
+    PrintRow(Item);
+  PrintRow(Total);
+
+  OS << "\nAST nodes:";
+  for (unsigned K = 0; K != num_ast_kinds; ++K)
+    OS << ' ' << ASTNodeNames[K] << '=' << NumASTNodes[K];
+  OS << '\n';
+
+  if (NumCacheHits || NumCacheMisses)
+    OS << "Function cache: " << NumCacheHits << " hits, " << NumCacheMisses
+       << " misses\n";
+}
+
+static void printJSON(llvm::raw_ostream &OS, const ItemStats &Total) {
+  llvm::json::OStream J(OS, 2);
+
+  auto PrintItem = [&](const ItemStats &Item) {
+    J.attribute("kind", Item.Kind);
+    J.attribute("name", Item.Name);
+    J.attributeObject("ms", [&] {
+      for (unsigned P = 0; P != num_phases; ++P)
+        J.attribute(PhaseNames[P], Item.Seconds[P] * 1000);
+      J.attribute("total", itemSeconds(Item) * 1000);
+    });
+    J.attribute("tokens", (int64_t)Item.Tokens);
+    J.attribute("ast_nodes", (int64_t)Item.ASTNodes);
+    J.attribute("instructions", (int64_t)Item.Instructions);
+    J.attribute("blocks", (int64_t)Item.Blocks);
+  };
+
+  J.object([&] {
+    J.attributeArray("items", [&] {
+      for (const ItemStats &Item : Items)
+        J.object([&] { PrintItem(Item); });
+    });
+    J.attributeObject("total", [&] {
+      PrintItem(Total);
+      J.attributeObject("ast_nodes_by_kind", [&] {
+        for (unsigned K = 0; K != num_ast_kinds; ++K)
+          J.attribute(ASTNodeNames[K], (int64_t)NumASTNodes[K]);
+      });
+      J.attribute("cache_hits", (int64_t)NumCacheHits);
+      J.attribute("cache_misses", (int64_t)NumCacheMisses);
+    });
+  });
+  OS << '\n';
+}
+
+void printTimeReport(llvm::raw_ostream &OS, ReportFormat Format) {
+  chargeActivePhase();
+  endItem();
+
+  ItemStats Total;
+  Total.Kind = "total";
+  Total.Tokens = NumTokens;
+  Total.ASTNodes = totalASTNodes();
+  for (const ItemStats &Item : Items) {
+    for (unsigned P = 0; P != num_phases; ++P)
+      Total.Seconds[P] += Item.Seconds[P];
+    Total.Instructions += Item.Instructions;
+    Total.Blocks += Item.Blocks;
+  }
+
+  if (Format == report_json)
+    printJSON(OS, Total);
+  else
+    printTable(OS, Total);
+}
@@ -0,0 +1,125 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+
+// The phases a run of the compiler is split into for --time-report
+enum Phase
+{
+  // Lexing and parsing one top-level item, the parser pulls tokens on
+  // demand so the two cannot be told apart
+  phase_parse,
+
+  // Working out and checking the types of the AST
+  phase_typecheck,
+
+  // Folding constants in the type checked AST
+  phase_simplify,
+
+  // Turning the AST into IR
+  phase_codegen,
+
+  // verifyFunction
+  phase_verify,
+
+  // The function and module pass pipelines
+  phase_optimize,
+
+  // Handing modules to the JIT and running top-level expressions
+  phase_jit,
+
+  // Moving functions generated on worker threads into the final module
+  phase_link,
+
+  // Looking functions up in the function cache and storing them there
+  phase_cache,
+
+  // Writing the final module out
+  phase_emit,
+
+  num_phases
+};
+
+// The AST node kinds counted by the parser
+enum ASTNodeKind
+{
+  ast_number,
+  ast_variable,
+  ast_unary,
+  ast_binary,
+  ast_call,
+  ast_cast,
+  ast_vector,
+  ast_index,
+  ast_if,
+  ast_for,
+  ast_var,
+  ast_prototype,
+  ast_function,
+
+  num_ast_kinds
+};
+
+// How printTimeReport lays out its output
+enum ReportFormat
+{
+  report_table,
+  report_json
+};
+
+// Set by --time-report before any input is read. Timers and IR counters
+// only run when it is on, token and AST counters always do. The report
+// covers the whole process, so it is only meant for main's single program
+extern bool TimeReportEnabled;
+
+// Bumped by the parsing thread, every thread counts its own
+extern thread_local unsigned long NumTokens;
+extern thread_local unsigned long NumASTNodes[num_ast_kinds];
+
+// Functions taken from and added to the function cache, from any thread
+extern std::atomic<unsigned long> NumCacheHits;
+extern std::atomic<unsigned long> NumCacheMisses;
+
+inline void countToken() { ++NumTokens; }
+inline void countASTNode(ASTNodeKind Kind) { ++NumASTNodes[Kind]; }
+
+// Starts a new row of the report, every phase timed and every counter
+// bumped from here on is charged to it. Kind is a short label such as
+// "def", "extern", "expr" or "module". Returns the row's index for
+// resumeItem, rows must only be begun while no other thread is timing
+unsigned beginItem(const char *Kind);
+
+// Makes an earlier row the current one of the calling thread again, e.g.
+// in the worker thread that generates the item's code
+void resumeItem(unsigned Row);
+
+// Names the current row once the item's name is known
+void setItemName(llvm::StringRef Name);
+
+// Adds the instructions and basic blocks of F to the current row
+void countIR(const llvm::Function &F);
+
+// Charges the time spent while it is in scope to Phase P of the calling
+// thread's current row. Timers nest and are exclusive: an inner timer (e.g.
+// verification inside codegen) pauses the outer one until it goes out of
+// scope. With several threads the rows add up the time of all of them
+class PhaseTimer
+{
+  Phase Outer;
+
+public:
+  explicit PhaseTimer(Phase P);
+  ~PhaseTimer();
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+// Prints one row per top-level item followed by the totals
+void printTimeReport(llvm::raw_ostream &OS, ReportFormat Format);
+
+#endif
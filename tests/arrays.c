@@ -0,0 +1,34 @@
+#include <stdint.h>
+#include <stdio.h>
+
+double axpy(double a, const double *x, double *y, int64_t n);
+double sum(const double *xs, int64_t n);
+double scale(float *xs, int64_t n, float k);
+double countsigns(const double *xs, int64_t n, int64_t *counts);
+
+int main()
+{
+    double x[8], y[8] __attribute__((aligned(16)));
+    float f[5] = {1.5f, -2, 0.25f, 8, 3};
+    int64_t counts[2] = {0, 0};
+
+    for (int i = 0; i < 8; i++) {
+        x[i] = i - 3;
+        y[i] = 10 * i;
+    }
+    axpy(2, x, y, 8);
+    for (int i = 0; i < 8; i++) {
+        printf("y[%d] = %f\n", i, y[i]);
+    }
+    printf("sum(y) = %f\n", sum(y, 8));
+    printf("sum(y, 3) = %f\n", sum(y, 3));
+
+    scale(f, 5, 0.5f);
+    for (int i = 0; i < 5; i++) {
+        printf("f[%d] = %f\n", i, f[i]);
+    }
+
+    countsigns(x, 8, counts);
+    printf("counts = %ld %ld\n", (long)counts[0], (long)counts[1]);
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include <stdio.h>
+
+double inrange(double x, double lo, double hi);
+double xor(double a, double b);
+double clamp(double x, double lo, double hi);
+double altsum(double n);
+
+int main()
+{
+    for (int i = -1; i < 4; i++) {
+        printf("inrange(%d, 0, 2) = %f\n", i, inrange(i, 0, 2));
+        printf("clamp(%d, 0, 2) = %f\n", i, clamp(i, 0, 2));
+    }
+    for (int a = 0; a < 2; a++)
+        for (int b = 0; b < 2; b++)
+            printf("xor(%d, %d) = %f\n", a, b, xor(a, b));
+    printf("altsum(10) = %f\n", altsum(10));
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include <stdint.h>
+#include <stdio.h>
+
+double sumsq(double n);
+double poly(double x);
+double dot(const double *xs, const double *ys, int64_t n);
+double twice(double x);
+double weighted(const double *xs, int64_t n, double k);
+
+double weight(double x)
+{
+    return x / 2;
+}
+
+int main()
+{
+    double xs[4] = {1, 2, 3, 4}, ys[4] = {4, 3, 2, 1};
+
+    printf("sumsq(10) = %f\n", sumsq(10));
+    for (int i = -1; i < 3; i++) {
+        printf("poly(%d) = %f\n", i, poly(i));
+        printf("twice(%d) = %f\n", i, twice(i));
+    }
+    printf("dot(xs, ys, 4) = %f\n", dot(xs, ys, 4));
+    printf("weighted(xs, 4, 3) = %f\n", weighted(xs, 4, 3));
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include <stdint.h>
+#include <stdio.h>
+
+double dotseq(double n);
+double axpylane(double a, int64_t lane);
+double reverselane(int64_t lane);
+double interleavelane(int64_t lane);
+double highlane(int64_t lane);
+double countbelow(double x, double limit);
+double spread(double a, double b, double c, double d);
+
+int main()
+{
+    for (int i = 0; i < 3; i++) {
+        printf("dotseq(%d) = %f\n", i, dotseq(i));
+    }
+    for (int64_t i = 0; i < 4; i++) {
+        printf("axpylane(2, %ld) = %f\n", (long)i, axpylane(2, i));
+        printf("reverselane(%ld) = %f\n", (long)i, reverselane(i));
+    }
+    for (int64_t i = 0; i < 8; i++) {
+        printf("interleavelane(%ld) = %f\n", (long)i, interleavelane(i));
+    }
+    for (int64_t i = 0; i < 2; i++) {
+        printf("highlane(%ld) = %f\n", (long)i, highlane(i));
+    }
+    printf("countbelow(0, 2.5) = %f\n", countbelow(0, 2.5));
+    printf("spread(3, 9, -1, 2) = %f\n", spread(3, 9, -1, 2));
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+double cond(double c);
+double below(double x, double y);
+double add(double x, double y);
+double sub(double x, double y);
+double mul(double x, double y);
+double nancond(void);
+double nanbelow(void);
+double negzero(void);
+double addnegzero(double x);
+double subzero(double x);
+double addzero(double x);
+double mulone(double x);
+double onemul(double x);
+double mulzero(double x);
+double roundoff(void);
+int64_t booladd(bool b, int64_t i);
+int64_t boolvar(int64_t i);
+double scale(int64_t x, double y);
+double widened(int64_t x);
+int64_t muli(int64_t x, int64_t y);
+int64_t wrap(void);
+int64_t inexact(void);
+float addf(float x, float y);
+float addf32(void);
+int64_t toint(double x);
+bool tobool(double x);
+int64_t nantoint(void);
+bool halftobool(void);
+
+static int failed = 0;
+
+// Folded and unfolded results must be the same double; all NaNs count as
+// one, their sign and payload are up to the hardware
+static void check(const char *name, double x, double folded, double unfolded)
+{
+    int same = isnan(folded) ? isnan(unfolded)
+                             : memcmp(&folded, &unfolded, sizeof(double)) == 0;
+    if (isnan(folded))
+        printf("%s(%g) = nan", name, x);
+    else
+        printf("%s(%g) = %g", name, x, folded);
+    printf("%s\n", same ? "" : " MISMATCH");
+    failed |= !same;
+}
+
+static void checki(const char *name, int64_t folded, int64_t unfolded)
+{
+    int same = folded == unfolded;
+    printf("%s = %ld%s\n", name, (long)folded, same ? "" : " MISMATCH");
+    failed |= !same;
+}
+
+int main()
+{
+    double values[] = {1.5, 0.0, -0.0, INFINITY, -INFINITY, NAN};
+
+    check("nancond", NAN, nancond(), cond(NAN));
+    check("nanbelow", NAN, nanbelow(), below(NAN, 1));
+    check("negzero", -1, negzero(), mul(-1, 0));
+    check("roundoff", 0.1, roundoff(), sub(add(0.1, 0.2), 0.3));
+    for (int i = 0; i < 6; i++) {
+        double x = values[i];
+        check("addnegzero", x, addnegzero(x), add(x, -0.0));
+        check("subzero", x, subzero(x), sub(x, 0.0));
+        check("addzero", x, addzero(x), add(x, 0.0));
+        check("mulone", x, mulone(x), mul(x, 1));
+        check("onemul", x, onemul(x), mul(1, x));
+        check("mulzero", x, mulzero(x), mul(x, 0));
+    }
+    for (int64_t i = 2; i < 5; i++) {
+        checki("boolvar", boolvar(i), booladd(true, i));
+        check("widened", i, widened(i), scale(i, 1));
+    }
+    checki("wrap", wrap(), muli(4611686018427387904, 2));
+    checki("inexact", inexact(), muli(3000000000, 3000000001));
+    check("addf32", 0.1, addf32(), addf(0.1f, 0.2f));
+    checki("nantoint", nantoint(), toint(NAN));
+    checki("halftobool", halftobool(), tobool(0.5));
+    return failed;
+}
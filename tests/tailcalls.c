@@ -0,0 +1,16 @@
+#include <stdint.h>
+#include <stdio.h>
+
+int64_t sumto(int64_t n, int64_t acc);
+int64_t countdown(int64_t n, int64_t acc);
+int64_t iseven(int64_t n);
+double fibacc(double n, double a, double b);
+
+int main()
+{
+    printf("sumto(10000000, 0) = %ld\n", (long)sumto(10000000, 0));
+    printf("countdown(10000000, 0) = %ld\n", (long)countdown(10000000, 0));
+    printf("iseven(10000001) = %ld\n", (long)iseven(10000001));
+    printf("fibacc(50, 0, 1) = %.0f\n", fibacc(50, 0, 1));
+    return 0;
+}
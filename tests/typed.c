@@ -0,0 +1,23 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+int64_t fibi(int64_t n);
+bool below(float x, float y);
+int64_t countbelow(float x, float limit);
+int64_t toint(double x);
+double average(int64_t a, int64_t b);
+
+int main()
+{
+    for (int64_t i = 1; i < 10; i++) {
+        printf("fibi(%ld) = %ld\n", (long)i, (long)fibi(i));
+    }
+    printf("fibi(90) = %ld\n", (long)fibi(90));
+    printf("below(1.5, 2) = %d\n", below(1.5f, 2.0f));
+    printf("countbelow(0.5, 2) = %ld\n", (long)countbelow(0.5f, 2.0f));
+    printf("toint(-3.7) = %ld\n", (long)toint(-3.7));
+    printf("toint(1e300) = %ld\n", (long)toint(1e300));
+    printf("average(3, 4) = %f\n", average(3, 4));
+    return 0;
+}